@@ -1,6 +1,7 @@
 // AsioMultipleContexts.cpp
 // Comprehensive educational example of using multiple io_context objects in standalone ASIO
 // Demonstrates LAN/WAN separation, thread pooling, and priority-based I/O handling
+// io_context is backed by a real epoll/eventfd reactor on Linux
 
 #include <iostream>
 #include <thread>
@@ -14,6 +15,23 @@
 #include <mutex>
 #include <functional>
 #include <condition_variable>
+#include <deque>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstdint>
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "MpscQueue.h"
 
 // Note: This example uses simulated ASIO patterns for educational purposes
 // For actual ASIO usage, install standalone ASIO: https://think-async.com/Asio/
@@ -29,53 +47,341 @@ using namespace std::chrono_literals;
 
 namespace SimulatedAsio {
 
+// Handle to one armed timer. The generation makes a stale handle (timer
+// already fired or cancelled, node reused) harmless.
+struct timer_id {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// Hierarchical timing wheel with 1 ms ticks (Varghese & Lauck; the same
+// scheme as the Linux kernel and tokio timers)
+//
+// - 6 levels × 64 slots. A level-L slot covers 64^L ticks, so the levels
+//   span 64 ms, 4 s, 4.4 min, 4.7 h, 12 days and 2.2 years
+// - A timer goes in the level where its expiry first differs from the
+//   current tick. When its slot comes due, it cascades down to a lower
+//   level; level 0 expires it.
+// - Each level has a 64-bit occupancy mask, so the next non-empty slot is
+//   found with a rotate and a count-trailing-zeros
+// - Nodes live in one vector and are linked into slots by index. Arm and
+//   cancel are O(1); freed nodes are reused from a free list.
+// - Timers armed already past due wait in a separate due list (an extra
+//   one-slot level) and expire on the next advance()
+//
+// Not thread-safe: io_context calls it with its mutex held.
+class TimerWheel {
+public:
+    static constexpr unsigned kLevels = 6;
+    static constexpr unsigned kSlotBits = 6;
+    static constexpr uint64_t kSlots = uint64_t{1} << kSlotBits;
+    static constexpr uint64_t kNoDeadline = UINT64_MAX;
+
+    TimerWheel() {
+        for (auto& level : heads_) {
+            std::fill(std::begin(level), std::end(level), kNil);
+        }
+    }
+
+    timer_id arm(uint64_t when, std::function<void()> handler) {
+        uint32_t index;
+        if (free_head_ != kNil) {
+            index = free_head_;
+            free_head_ = nodes_[index].next;
+        } else {
+            index = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        Node& node = nodes_[index];
+        node.handler = std::move(handler);
+        node.when = when;
+        node.armed = true;
+        link(index);
+        ++size_;
+        return {index, node.generation};
+    }
+
+    bool cancel(timer_id id) {
+        if (id.index >= nodes_.size() || !nodes_[id.index].armed ||
+            nodes_[id.index].generation != id.generation) {
+            return false;
+        }
+        unlink(id.index);
+        release(id.index);
+        return true;
+    }
+
+    // Processes every slot due at or before `now`. Expired handlers go to
+    // expire(handler) in deadline order; whole slots expire in one pass.
+    template<typename Expire>
+    void advance(uint64_t now, Expire&& expire) {
+        for (Due due = next_due(); due.deadline <= now; due = next_due()) {
+            elapsed_ = due.deadline;
+            uint32_t index = heads_[due.level][due.slot];
+            heads_[due.level][due.slot] = kNil;
+            occupied_[due.level] &= ~(uint64_t{1} << due.slot);
+
+            while (index != kNil) {
+                uint32_t next = nodes_[index].next;
+                if (nodes_[index].when <= elapsed_) {
+                    expire(std::move(nodes_[index].handler));
+                    release(index);
+                } else {
+                    link(index);  // Cascade to a lower level
+                }
+                index = next;
+            }
+        }
+        elapsed_ = std::max(elapsed_, now);
+    }
+
+    // Tick at which advance() next has work (an expiry or a cascade)
+    uint64_t next_deadline() const { return next_due().deadline; }
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+    std::size_t memory_bytes() const { return nodes_.capacity() * sizeof(Node); }
+
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+    static constexpr uint64_t kMaxSpan = (uint64_t{1} << (kLevels * kSlotBits)) - 1;
+
+    struct Node {
+        std::function<void()> handler;
+        uint64_t when = 0;
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+        uint32_t generation = 0;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool armed = false;
+    };
+
+    struct Due {
+        uint64_t deadline;
+        unsigned level;
+        unsigned slot;
+    };
+
+    std::vector<Node> nodes_;
+    uint32_t free_head_ = kNil;
+    std::size_t size_ = 0;
+    uint64_t elapsed_ = 0;  // Last tick processed
+    static constexpr unsigned kDueLevel = kLevels;  // One slot: already due
+    uint64_t occupied_[kLevels + 1] = {};
+    uint32_t heads_[kLevels + 1][kSlots];
+
+    void link(uint32_t index) {
+        Node& node = nodes_[index];
+        unsigned level = kDueLevel;
+        unsigned slot = 0;
+        if (node.when > elapsed_) {
+            const uint64_t diff = std::min((node.when ^ elapsed_) | (kSlots - 1), kMaxSpan);
+            level = (std::bit_width(diff) - 1) / kSlotBits;
+            slot = (node.when >> (level * kSlotBits)) & (kSlots - 1);
+        }
+
+        node.level = static_cast<uint8_t>(level);
+        node.slot = static_cast<uint8_t>(slot);
+        node.prev = kNil;
+        node.next = heads_[level][slot];
+        if (node.next != kNil) {
+            nodes_[node.next].prev = index;
+        }
+        heads_[level][slot] = index;
+        occupied_[level] |= uint64_t{1} << slot;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes_[index];
+        if (node.prev != kNil) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            heads_[node.level][node.slot] = node.next;
+            if (node.next == kNil) {
+                occupied_[node.level] &= ~(uint64_t{1} << node.slot);
+            }
+        }
+        if (node.next != kNil) {
+            nodes_[node.next].prev = node.prev;
+        }
+    }
+
+    void release(uint32_t index) {
+        Node& node = nodes_[index];
+        node.handler = nullptr;
+        node.armed = false;
+        ++node.generation;
+        node.next = free_head_;
+        free_head_ = index;
+        --size_;
+    }
+
+    // Lower levels always come due first: an occupied level-L slot lies in
+    // the current level-L rotation, which ends where level L+1's next slot
+    // begins
+    Due next_due() const {
+        if (occupied_[kDueLevel] != 0) {
+            return {elapsed_, kDueLevel, 0};
+        }
+        for (unsigned level = 0; level < kLevels; ++level) {
+            if (occupied_[level] == 0) {
+                continue;
+            }
+            const unsigned shift = level * kSlotBits;
+            const uint64_t slot_range = uint64_t{1} << shift;
+            const uint64_t level_range = slot_range << kSlotBits;
+            // Search from the slot after the current one. Slots at or before
+            // it only occur on the top level and hold expiries beyond its
+            // span: they belong to the next rotation.
+            const unsigned now_slot = (elapsed_ >> shift) & (kSlots - 1);
+            const unsigned first = (now_slot + 1) & (kSlots - 1);
+            const unsigned slot =
+                (first + std::countr_zero(std::rotr(occupied_[level], static_cast<int>(first)))) &
+                (kSlots - 1);
+            uint64_t deadline = (elapsed_ & ~(level_range - 1)) + slot * slot_range;
+            if (slot <= now_slot) {
+                deadline += level_range;
+            }
+            return {deadline, level, slot};
+        }
+        return {kNoDeadline, 0, 0};
+    }
+};
+
 // Simulate asio::io_context
+//
+// On Linux this is a real reactor, organised like asio's scheduler:
+// - Ready handlers wait in a FIFO queue and run in posting order
+// - At most one idle thread blocks in epoll_wait() (the "poller"); the
+//   other idle threads sleep on a condition variable
+// - post() wakes a sleeping thread, or writes to an eventfd registered with
+//   epoll when the only idle thread is the poller
+// - async_wait(fd, ...) arms one-shot readiness interest in a socket/pipe;
+//   the handler is queued when epoll reports the fd ready
+// - Timers live in a TimerWheel; the poller's epoll_wait() timeout is the
+//   wheel's next deadline, and due timers are queued as ordinary handlers
+//
+// Outstanding work = queued handlers + running handlers + pending fd waits
+// + armed timers + work guards.
+// run() returns when it drops to zero, or after stop(). Like asio, the
+// context then stays stopped until restart().
+//
+// Without epoll (non-Linux) idle threads only use the condition variable
+// (with a timeout while timers are armed) and async_wait() is not available.
 class io_context {
+public:
+    enum class wait_type { read, write };
+
 private:
+    // Pending one-shot waits for one fd
+    struct FdOps {
+        std::function<void()> on_readable;
+        std::function<void()> on_writable;
+        bool in_epoll = false;
+    };
+
+    struct QueuedHandler {
+        std::function<void()> handler;
+        int fd;  // Readiness handler for fd, so cancel() can find it; else -1
+    };
+
     std::atomic<bool> stopped_{false};
-    std::atomic<int> work_count_{0};
-    std::vector<std::function<void()>> pending_work_;
-    std::mutex work_mutex_;
-    std::condition_variable work_cv_;
+    std::mutex mutex_;
+    std::condition_variable idle_cv_;
+    std::deque<QueuedHandler> handlers_;  // FIFO
+    std::size_t outstanding_work_ = 0;
+    std::size_t idle_waiters_ = 0;     // Threads asleep on idle_cv_
+    bool polling_ = false;             // A thread is inside epoll_wait()
+    bool poller_interrupted_ = false;  // eventfd already written
+    std::unordered_map<int, FdOps> fd_ops_;
+    TimerWheel timers_;
+    const std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now();
+    uint64_t poll_deadline_ = TimerWheel::kNoDeadline;  // Tick the poller wakes at
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
     std::string name_;  // For debugging
     
 public:
-    explicit io_context(const std::string& name = "io_context") : name_(name) {}
+    explicit io_context(const std::string& name = "io_context") : name_(name) {
+#ifdef __linux__
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event ev{};
+        ev.events = EPOLLIN;  // Level-triggered: stays ready until drained
+        ev.data.fd = wake_fd_;
+        if (epoll_fd_ < 0 || wake_fd_ < 0 ||
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) < 0) {
+            close_fds();
+            throw std::runtime_error("io_context: cannot create epoll/eventfd");
+        }
+#endif
+    }
+
+    ~io_context() { close_fds(); }
+
+    io_context(const io_context&) = delete;
+    io_context& operator=(const io_context&) = delete;
     
     // Main event loop - blocks until no more work
     void run() {
         std::cout << "[" << name_ << "] Thread " << std::this_thread::get_id() 
                   << " calling run()\n";
         
+        std::unique_lock<std::mutex> lock(mutex_);
         while (!stopped_) {
-            std::function<void()> work;
-            
-            {
-                std::unique_lock<std::mutex> lock(work_mutex_);
-                work_cv_.wait_for(lock, 50ms, [this] {
-                    return !pending_work_.empty() || stopped_;
-                });
-                
-                if (stopped_ && pending_work_.empty()) {
-                    break;
-                }
-                
-                if (!pending_work_.empty()) {
-                    work = std::move(pending_work_.back());
-                    pending_work_.pop_back();
-                }
+            if (!timers_.empty()) {
+                expire_timers_locked();
             }
-            
-            if (work) {
-                work();
-                --work_count_;
+
+            if (!handlers_.empty()) {
+                auto handler = std::move(handlers_.front().handler);
+                handlers_.pop_front();
+                lock.unlock();
+                handler();
+                lock.lock();
+                work_finished_locked();
+                continue;
             }
-            
-            // If no more work, exit
-            if (work_count_ == 0 && pending_work_.empty()) {
+
+            // Nothing queued and nothing running anywhere: we're done
+            if (outstanding_work_ == 0) {
+                stop_locked();
                 break;
             }
+
+#ifdef __linux__
+            if (!polling_) {
+                polling_ = true;
+                poll_deadline_ = timers_.next_deadline();
+                const int timeout = ms_until(poll_deadline_);
+                lock.unlock();
+                epoll_event events[64];
+                int ready = epoll_wait(epoll_fd_, events, 64, timeout);
+                lock.lock();
+                polling_ = false;
+                poller_interrupted_ = false;
+                poll_deadline_ = TimerWheel::kNoDeadline;
+                for (int i = 0; i < ready; ++i) {
+                    dispatch_event_locked(events[i]);
+                }
+                share_handlers_locked();
+                continue;
+            }
+            ++idle_waiters_;
+            idle_cv_.wait(lock);
+            --idle_waiters_;
+#else
+            ++idle_waiters_;
+            if (timers_.empty()) {
+                idle_cv_.wait(lock);
+            } else {
+                idle_cv_.wait_for(lock, std::chrono::milliseconds(ms_until(timers_.next_deadline())));
+            }
+            --idle_waiters_;
+#endif
         }
+        lock.unlock();
         
         std::cout << "[" << name_ << "] Thread " << std::this_thread::get_id() 
                   << " exiting run()\n";
@@ -83,52 +389,408 @@ public:
     
     // Post work to the io_context
     void post(std::function<void()> handler) {
-        {
-            std::lock_guard<std::mutex> lock(work_mutex_);
-            pending_work_.push_back(std::move(handler));
-            ++work_count_;
+        std::lock_guard<std::mutex> lock(mutex_);
+        handlers_.push_back({std::move(handler), -1});
+        ++outstanding_work_;
+        wake_one_locked();
+    }
+
+    // Queues handler once `deadline` has passed (1 ms resolution, never
+    // early). No thread per timer: the run() threads drive the wheel.
+    timer_id arm_timer(std::chrono::steady_clock::time_point deadline,
+                       std::function<void()> handler) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t tick = tick_at_or_after(deadline);
+        timer_id id = timers_.arm(tick, std::move(handler));
+        ++outstanding_work_;
+        // The poller may be sleeping towards a later deadline
+#ifdef __linux__
+        if (tick < poll_deadline_) {
+            interrupt_poller_locked();
         }
-        work_cv_.notify_one();
+#else
+        idle_cv_.notify_one();
+#endif
+        return id;
+    }
+
+    // True if the timer was still armed; its handler is destroyed unrun
+    bool cancel_timer(timer_id id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!timers_.cancel(id)) {
+            return false;
+        }
+        work_finished_locked();
+        return true;
+    }
+
+    std::size_t timers_pending() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timers_.size();
+    }
+
+    std::size_t timer_memory_bytes() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timers_.memory_bytes();
+    }
+
+#ifdef __linux__
+    // Runs handler (once) on a run() thread when fd becomes readable or
+    // writable; hang-ups and errors also count as ready. One wait per
+    // direction per fd. Re-arm from inside the handler to keep listening.
+    void async_wait(int fd, wait_type type, std::function<void()> handler) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        FdOps& ops = fd_ops_[fd];
+        auto& slot = (type == wait_type::read) ? ops.on_readable : ops.on_writable;
+        if (slot) {
+            throw std::runtime_error("io_context: fd already has a pending wait");
+        }
+        slot = std::move(handler);
+        ++outstanding_work_;
+        arm_locked(fd, ops);
+    }
+
+    // Drops the pending waits on fd, including readiness already delivered
+    // but still queued for run() (their handlers are destroyed without
+    // running), and removes it from epoll. Call before closing the fd. A
+    // handler that a run() thread has already started is not stopped.
+    void cancel(int fd) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::size_t dropped = 0;
+        auto it = fd_ops_.find(fd);
+        if (it != fd_ops_.end()) {
+            if (it->second.in_epoll) {
+                epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+            }
+            dropped += (it->second.on_readable ? 1 : 0) + (it->second.on_writable ? 1 : 0);
+            fd_ops_.erase(it);
+        }
+        for (auto queued = handlers_.begin(); queued != handlers_.end();) {
+            if (queued->fd == fd) {
+                queued = handlers_.erase(queued);
+                ++dropped;
+            } else {
+                ++queued;
+            }
+        }
+        for (std::size_t i = 0; i < dropped; ++i) {
+            work_finished_locked();
+        }
+    }
+#endif
+    
+    // Outstanding work that is not a handler (see executor_work_guard)
+    void on_work_started() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++outstanding_work_;
+    }
+
+    void on_work_finished() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        work_finished_locked();
     }
     
     // Stop the io_context
     void stop() {
-        stopped_ = true;
-        work_cv_.notify_all();
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_locked();
+    }
+
+    // Allows run() again after stop() or after running out of work
+    void restart() {
+        stopped_ = false;
     }
+
+    bool stopped() const { return stopped_; }
     
     const std::string& name() const { return name_; }
+
+private:
+    uint64_t now_tick() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - epoch_).count());
+    }
+
+    uint64_t tick_at_or_after(std::chrono::steady_clock::time_point tp) const {
+        if (tp <= epoch_) {
+            return 0;
+        }
+        return static_cast<uint64_t>(std::chrono::ceil<std::chrono::milliseconds>(tp - epoch_).count());
+    }
+
+    // Timeout (rounded up) for a wait that should end at `tick`; -1 means forever
+    int ms_until(uint64_t tick) const {
+        if (tick == TimerWheel::kNoDeadline) {
+            return -1;
+        }
+        const auto remaining = epoch_ + std::chrono::milliseconds(tick) - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero()) {
+            return 0;
+        }
+        return static_cast<int>(std::min<int64_t>(
+            std::chrono::ceil<std::chrono::milliseconds>(remaining).count(), INT_MAX));
+    }
+
+    // Due timers join the FIFO queue in one batch
+    void expire_timers_locked() {
+        timers_.advance(now_tick(), [this](std::function<void()>&& handler) {
+            handlers_.push_back({std::move(handler), -1});
+        });
+        share_handlers_locked();
+    }
+
+    // The calling thread runs one queued handler itself. Wake sleepers for
+    // the rest, plus one to take over epoll_wait() if nobody is polling, so
+    // sockets and timers stay watched while handlers run.
+    void share_handlers_locked() {
+        if (handlers_.empty()) {
+            return;
+        }
+        std::size_t wake = handlers_.size() - 1;
+#ifdef __linux__
+        if (!polling_) {
+            ++wake;
+        }
+#endif
+        for (std::size_t i = 0; i < wake && i < idle_waiters_; ++i) {
+            idle_cv_.notify_one();
+        }
+    }
+
+    void work_finished_locked() {
+        if (--outstanding_work_ == 0) {
+            stop_locked();
+        }
+    }
+
+    void stop_locked() {
+        stopped_ = true;
+        idle_cv_.notify_all();
+        interrupt_poller_locked();
+    }
+
+    void wake_one_locked() {
+        if (idle_waiters_ > 0) {
+            idle_cv_.notify_one();
+        } else {
+            interrupt_poller_locked();
+        }
+    }
+
+    void interrupt_poller_locked() {
+#ifdef __linux__
+        if (polling_ && !poller_interrupted_) {
+            poller_interrupted_ = true;
+            uint64_t one = 1;
+            [[maybe_unused]] ssize_t n = write(wake_fd_, &one, sizeof(one));
+        }
+#endif
+    }
+
+#ifdef __linux__
+    void arm_locked(int fd, FdOps& ops) {
+        epoll_event ev{};
+        ev.events = EPOLLONESHOT | (ops.on_readable ? EPOLLIN : 0u) |
+                    (ops.on_writable ? EPOLLOUT : 0u);
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, ops.in_epoll ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev) < 0) {
+            throw std::runtime_error("io_context: epoll_ctl failed for fd " + std::to_string(fd));
+        }
+        ops.in_epoll = true;
+    }
+
+    // Called by the poller with the lock held
+    void dispatch_event_locked(const epoll_event& ev) {
+        if (ev.data.fd == wake_fd_) {
+            uint64_t count;
+            [[maybe_unused]] ssize_t n = read(wake_fd_, &count, sizeof(count));
+            return;
+        }
+
+        auto it = fd_ops_.find(ev.data.fd);
+        if (it == fd_ops_.end()) {
+            return;  // Cancelled while the poller was waiting
+        }
+        FdOps& ops = it->second;
+        const bool failed = ev.events & (EPOLLERR | EPOLLHUP);
+        if (ops.on_readable && (failed || (ev.events & EPOLLIN))) {
+            handlers_.push_back({std::move(ops.on_readable), ev.data.fd});
+            ops.on_readable = nullptr;
+        }
+        if (ops.on_writable && (failed || (ev.events & EPOLLOUT))) {
+            handlers_.push_back({std::move(ops.on_writable), ev.data.fd});
+            ops.on_writable = nullptr;
+        }
+        // One-shot disarmed the fd; re-enable it for the direction still waiting
+        if (ops.on_readable || ops.on_writable) {
+            arm_locked(ev.data.fd, ops);
+        }
+    }
+#endif
+
+    void close_fds() {
+#ifdef __linux__
+        if (wake_fd_ >= 0) {
+            ::close(wake_fd_);
+        }
+        if (epoll_fd_ >= 0) {
+            ::close(epoll_fd_);
+        }
+        wake_fd_ = epoll_fd_ = -1;
+#endif
+    }
 };
 
 // Simulate asio::steady_timer
+// A handle to one entry in its io_context's timer wheel. The expiry is
+// fixed when the timer is constructed (or by expires_after()), as in asio.
 class steady_timer {
 private:
     io_context& io_;
-    std::chrono::milliseconds duration_;
-    std::jthread timer_thread_;
+    std::chrono::steady_clock::time_point expiry_;
+    timer_id id_;
     
 public:
     steady_timer(io_context& io, std::chrono::milliseconds ms) 
-        : io_(io), duration_(ms) {}
+        : io_(io), expiry_(std::chrono::steady_clock::now() + ms) {}
+
+    ~steady_timer() { cancel(); }
+
+    steady_timer(const steady_timer&) = delete;
+    steady_timer& operator=(const steady_timer&) = delete;
+
+    // Cancels any pending wait
+    void expires_after(std::chrono::milliseconds ms) {
+        cancel();
+        expiry_ = std::chrono::steady_clock::now() + ms;
+    }
     
     void async_wait(std::function<void()> handler) {
-        // Start timer in background, then post handler to io_context
-        timer_thread_ = std::jthread([this, h = std::move(handler)]() {
-            std::this_thread::sleep_for(duration_);
-            io_.post(h);  // Post to io_context when timer expires
-        });
+        cancel();
+        id_ = io_.arm_timer(expiry_, std::move(handler));
+    }
+
+    // True if a pending wait was removed (its handler never runs)
+    bool cancel() {
+        return io_.cancel_timer(std::exchange(id_, timer_id{}));
     }
 };
 
 // Work guard to keep io_context alive
+// Counts as one unit of outstanding work until reset() or destruction, so
+// run() keeps waiting for handlers that have not been posted yet.
 template<typename Executor>
 class executor_work_guard {
 private:
-    io_context& io_;
+    Executor* io_;
     
 public:
-    explicit executor_work_guard(io_context& io) : io_(io) {}
-    ~executor_work_guard() = default;
+    explicit executor_work_guard(Executor& io) : io_(&io) {
+        io_->on_work_started();
+    }
+
+    executor_work_guard(executor_work_guard&& other) noexcept
+        : io_(std::exchange(other.io_, nullptr)) {}
+
+    executor_work_guard(const executor_work_guard&) = delete;
+    executor_work_guard& operator=(const executor_work_guard&) = delete;
+    executor_work_guard& operator=(executor_work_guard&&) = delete;
+
+    ~executor_work_guard() { reset(); }
+
+    // Releases the work; run() returns once everything else is done
+    void reset() {
+        if (Executor* io = std::exchange(io_, nullptr)) {
+            io->on_work_finished();
+        }
+    }
+
+    bool owns_work() const { return io_ != nullptr; }
+};
+
+inline executor_work_guard<io_context> make_work_guard(io_context& io) {
+    return executor_work_guard<io_context>(io);
+}
+
+// Simulate asio::strand<io_context::executor_type>
+//
+// Handlers posted through one strand run one at a time, in posting order,
+// on whichever io_context threads pick them up. No mutex is involved:
+// - post() pushes onto an intrusive MPSC queue (MpscQueue.h): one exchange
+//   on the tail, then a release store linking the previous node
+// - pending_ counts handlers posted but not yet finished. The post() that
+//   raises it from 0 schedules a drain on the io_context; later posts only
+//   enqueue.
+// - The drain runs up to kBatch handlers, then re-posts itself so other
+//   strands and handlers on the context get a turn. It ends when its
+//   decrement takes pending_ back to 0.
+// Only one drain exists at a time, and pending_ is updated with acq_rel, so
+// each handler sees everything its predecessors wrote: per-connection
+// state needs no lock.
+class strand {
+private:
+    struct Node : MpscNode {
+        explicit Node(std::function<void()> h) : handler(std::move(h)) {}
+        std::function<void()> handler;
+    };
+
+    struct Impl {
+        static constexpr int kBatch = 64;
+        static inline thread_local const Impl* current = nullptr;
+
+        io_context& io;
+        MpscQueue<Node> queue;  // Popped only by the active drain
+        std::atomic<std::size_t> pending{0};
+
+        explicit Impl(io_context& ctx) : io(ctx) {}
+
+        ~Impl() {
+            // Left over only if the io_context was destroyed with a drain queued
+            while (Node* node = queue.try_pop()) {
+                delete node;
+            }
+        }
+
+        static void post(const std::shared_ptr<Impl>& self, std::function<void()> handler) {
+            self->queue.push(new Node{std::move(handler)});
+            if (self->pending.fetch_add(1, std::memory_order_acq_rel) == 0) {
+                self->io.post([self]() { self->drain(self); });
+            }
+        }
+
+        void drain(const std::shared_ptr<Impl>& self) {
+            const Impl* outer = std::exchange(current, this);
+            for (int i = 0; i < kBatch; ++i) {
+                Node* node;
+                // pending > 0 guarantees a node; a producer may still be linking it
+                while ((node = queue.try_pop()) == nullptr) {
+                    std::this_thread::yield();
+                }
+                node->handler();
+                delete node;
+                if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    current = outer;
+                    return;
+                }
+            }
+            current = outer;
+            io.post([self]() { self->drain(self); });
+        }
+    };
+
+    std::shared_ptr<Impl> impl_;
+
+public:
+    explicit strand(io_context& io) : impl_(std::make_shared<Impl>(io)) {}
+
+    void post(std::function<void()> handler) {
+        Impl::post(impl_, std::move(handler));
+    }
+
+    // True inside a handler of this strand
+    bool running_in_this_thread() const {
+        return Impl::current == impl_.get();
+    }
 };
 
 } // namespace SimulatedAsio
@@ -206,6 +868,78 @@ void demonstrate_thread_pool_pattern() {
     
     std::cout << "\n✓ 6 tasks distributed across 3 threads automatically\n";
     std::cout << "✓ This is the standard ASIO thread pool pattern\n";
+    
+    // --- Per-connection ordering on the same pool
+    std::cout << "\nPer-connection ordering: one strand per connection, no mutex\n";
+    std::cout << "Work guard: threads start before any request arrives\n\n";
+    
+    SimulatedAsio::io_context io_pool("strand_pool");
+    auto guard = SimulatedAsio::make_work_guard(io_pool);
+    
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 3; ++i) {
+        workers.emplace_back([&io_pool]() { io_pool.run(); });
+    }
+    
+    // Plain (non-atomic) per-connection state: only its strand touches it
+    struct ConnectionState {
+        explicit ConnectionState(SimulatedAsio::io_context& io) : strand(io) {}
+        SimulatedAsio::strand strand;
+        std::vector<int> handled;
+        bool busy = false;
+        bool overlapped = false;
+    };
+    constexpr int kConnections = 4;
+    constexpr int kRequests = 12;
+    std::vector<std::unique_ptr<ConnectionState>> connections;
+    for (int c = 0; c < kConnections; ++c) {
+        connections.push_back(std::make_unique<ConnectionState>(io_pool));
+    }
+    
+    std::atomic<int> in_flight{0};
+    std::atomic<int> max_in_flight{0};
+    
+    // Requests arrive over time, interleaved across connections
+    for (int r = 0; r < kRequests; ++r) {
+        for (auto& conn : connections) {
+            ConnectionState* state = conn.get();
+            state->strand.post([state, r, &in_flight, &max_in_flight]() {
+                state->overlapped |= state->busy;
+                state->busy = true;
+                int now = ++in_flight;
+                int seen = max_in_flight.load();
+                while (now > seen && !max_in_flight.compare_exchange_weak(seen, now)) {
+                }
+                std::this_thread::sleep_for(2ms);  // Simulated request handling
+                state->handled.push_back(r);
+                --in_flight;
+                state->busy = false;
+            });
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    
+    guard.reset();  // run() may now return once the strands drain
+    for (auto& t : workers) {
+        t.join();
+    }
+    
+    bool all_ordered = true;
+    for (int c = 0; c < kConnections; ++c) {
+        const auto& state = *connections[c];
+        bool ordered = state.handled.size() == kRequests &&
+                       std::is_sorted(state.handled.begin(), state.handled.end());
+        all_ordered &= ordered && !state.overlapped;
+        std::cout << "  Connection " << c + 1 << ": " << state.handled.size() << " requests, "
+                  << (ordered ? "in order" : "OUT OF ORDER")
+                  << (state.overlapped ? ", overlapped!" : ", never concurrent") << "\n";
+    }
+    std::cout << "  Handlers in flight across connections: up to " << max_in_flight.load() << "\n";
+    
+    std::cout << "\n" << (all_ordered ? "✓" : "✗")
+              << " Each connection's handlers ran one at a time, in order\n";
+    std::cout << "✓ Different connections still ran in parallel on the pool\n";
+    std::cout << "✓ run() stayed alive on the work guard until reset()\n";
 }
 
 // ============================================================================
@@ -263,15 +997,20 @@ void demonstrate_lan_wan_separation() {
     auto wan_client1 = std::make_shared<Connection>("PublicAPI", "WAN");
     auto wan_client2 = std::make_shared<Connection>("MobileApp", "WAN");
     
+    // io_lan has two threads: a strand per connection keeps each
+    // connection's requests (and its request counter) sequential
+    SimulatedAsio::strand lan_strand1(io_lan);
+    SimulatedAsio::strand lan_strand2(io_lan);
+    
     std::cout << "Posting work to both contexts...\n\n";
     
     // Post LAN work (fast, high priority)
     for (int i = 1; i <= 3; ++i) {
-        io_lan.post([lan_client1, i]() {
+        lan_strand1.post([lan_client1, i]() {
             lan_client1->handle_request(i);
         });
         
-        io_lan.post([lan_client2, i]() {
+        lan_strand2.post([lan_client2, i]() {
             lan_client2->handle_request(i);
         });
     }
@@ -482,6 +1221,7 @@ void demonstrate_run_call_patterns() {
     std::cout << "  2. Multiple threads CAN call run() on SAME io_context (thread pool)\n";
     std::cout << "  3. One thread should NOT call run() on MULTIPLE io_contexts\n";
     std::cout << "  4. run() returns when work queue is empty (use work_guard to prevent)\n";
+    std::cout << "     (Section 2 runs a pool on a work guard with per-connection strands)\n";
     std::cout << "  5. Call stop() to force run() to exit early\n\n";
 }
 
@@ -597,6 +1337,275 @@ void demonstrate_best_practices() {
     std::cout << "  6. Profile before optimizing - one io_context is often sufficient\n\n";
 }
 
+// ============================================================================
+// SECTION 9: Real Sockets on the Reactor (epoll + eventfd)
+// ============================================================================
+
+#ifdef __linux__
+
+// Server side of one connection. Runs only on readiness callbacks: read
+// what arrived, echo it back, wait again. EOF ends the session, and with
+// it that connection's outstanding work.
+class EchoSession : public std::enable_shared_from_this<EchoSession> {
+private:
+    SimulatedAsio::io_context& io_;
+    int fd_;
+    std::string label_;
+    int replies_ = 0;
+    
+public:
+    EchoSession(SimulatedAsio::io_context& io, int fd, std::string label)
+        : io_(io), fd_(fd), label_(std::move(label)) {}
+    
+    void start() { wait_readable(); }
+    
+private:
+    void wait_readable() {
+        auto self = shared_from_this();
+        io_.async_wait(fd_, SimulatedAsio::io_context::wait_type::read,
+                       [self]() { self->on_readable(); });
+    }
+    
+    void on_readable() {
+        char buf[256];
+        ssize_t n = ::read(fd_, buf, sizeof(buf));
+        if (n <= 0) {
+            std::cout << "  [" << label_ << "] Peer closed after " << replies_ << " replies\n";
+            io_.cancel(fd_);
+            ::close(fd_);
+            return;
+        }
+        // Small replies on a local socket fit in the send buffer
+        if (::write(fd_, buf, static_cast<size_t>(n)) == n) {
+            ++replies_;
+        }
+        wait_readable();
+    }
+};
+
+// Blocking client: request, wait for the echo, repeat. Returns mean RTT.
+static double run_echo_client(int fd, int requests) {
+    auto start = std::chrono::steady_clock::now();
+    char buf[64];
+    for (int i = 0; i < requests; ++i) {
+        std::string msg = "req " + std::to_string(i);
+        if (::write(fd, msg.data(), msg.size()) != static_cast<ssize_t>(msg.size()) ||
+            ::read(fd, buf, sizeof(buf)) <= 0) {
+            break;
+        }
+    }
+    ::shutdown(fd, SHUT_WR);  // Server sees EOF
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / requests;
+}
+
+void demonstrate_reactor_sockets() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 9. Real Sockets on the Reactor (epoll + eventfd) ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    std::cout << "Each io_context owns an epoll instance:\n";
+    std::cout << "  • async_wait(fd, read) → handler queued when the socket is readable\n";
+    std::cout << "  • post() from another thread → eventfd write wakes epoll_wait()\n";
+    std::cout << "  • Handlers run FIFO; run() returns when no work is outstanding\n\n";
+    
+    // --- Part 1: LAN and WAN contexts serving real (local) sockets
+    std::cout << "--- LAN/WAN contexts echoing over socketpairs ---\n\n";
+    
+    SimulatedAsio::io_context io_lan("io_LAN");
+    SimulatedAsio::io_context io_wan("io_WAN");
+    
+    int lan_pair[2];
+    int wan_pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, lan_pair) < 0 ||
+        socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, wan_pair) < 0) {
+        std::cout << "✗ socketpair() failed, skipping\n";
+        return;
+    }
+    
+    // Pending reads are outstanding work: run() will not return early
+    std::make_shared<EchoSession>(io_lan, lan_pair[0], "LAN server")->start();
+    std::make_shared<EchoSession>(io_wan, wan_pair[0], "WAN server")->start();
+    
+    std::thread lan_thread([&]() { io_lan.run(); });
+    std::thread wan_thread([&]() { io_wan.run(); });
+    
+    constexpr int kRequests = 2000;
+    double lan_rtt = 0.0;
+    double wan_rtt = 0.0;
+    std::thread lan_client([&]() { lan_rtt = run_echo_client(lan_pair[1], kRequests); });
+    std::thread wan_client([&]() { wan_rtt = run_echo_client(wan_pair[1], kRequests); });
+    
+    lan_client.join();
+    wan_client.join();
+    lan_thread.join();
+    wan_thread.join();
+    ::close(lan_pair[1]);
+    ::close(wan_pair[1]);
+    
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "\n  LAN client: " << kRequests << " round trips, mean " << lan_rtt << " µs\n";
+    std::cout << "  WAN client: " << kRequests << " round trips, mean " << wan_rtt << " µs\n\n";
+    
+    // --- Part 2: cross-thread post() latency into an idle context
+    std::cout << "--- post() → handler latency while the loop sits in epoll_wait() ---\n\n";
+    
+    SimulatedAsio::io_context io("io_LATENCY");
+    int idle_pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, idle_pair) < 0) {
+        std::cout << "✗ socketpair() failed, skipping\n";
+        return;
+    }
+    // A read nobody satisfies keeps run() alive, like a listening socket
+    io.async_wait(idle_pair[0], SimulatedAsio::io_context::wait_type::read, []() {});
+    std::thread loop([&]() { io.run(); });
+    
+    constexpr int kSamples = 500;
+    std::vector<double> latency_us;
+    latency_us.reserve(kSamples);
+    std::atomic<bool> ran{false};
+    std::chrono::steady_clock::time_point started;
+    
+    for (int i = 0; i < kSamples; ++i) {
+        std::this_thread::sleep_for(200us);  // Let the loop go back to sleep
+        ran.store(false);
+        auto posted = std::chrono::steady_clock::now();
+        io.post([&]() {
+            started = std::chrono::steady_clock::now();
+            ran.store(true);
+            ran.notify_one();
+        });
+        ran.wait(false);
+        latency_us.push_back(std::chrono::duration<double, std::micro>(started - posted).count());
+    }
+    
+    io.cancel(idle_pair[0]);  // Last outstanding work → run() returns
+    loop.join();
+    ::close(idle_pair[0]);
+    ::close(idle_pair[1]);
+    
+    std::sort(latency_us.begin(), latency_us.end());
+    std::cout << "\n  " << kSamples << " posts: p50 " << latency_us[kSamples / 2]
+              << " µs, p99 " << latency_us[kSamples * 99 / 100]
+              << " µs, max " << latency_us.back() << " µs\n";
+    std::cout << std::defaultfloat << std::setprecision(6);
+    
+    std::cout << "\n✓ Idle contexts block in epoll_wait() - no 50 ms polling loop\n";
+    std::cout << "✓ Cross-thread post() wakes the loop through its eventfd\n";
+    std::cout << "✓ Socket readiness and posted handlers share one FIFO queue\n";
+}
+
+#endif
+
+// ============================================================================
+// SECTION 10: Timer Wheel - A Million Timeouts on One Context
+// ============================================================================
+
+void demonstrate_timer_wheel() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 10. Timer Wheel: A Million Timeouts on One Context ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    std::cout << "steady_timer is an entry in its io_context's hierarchical wheel:\n";
+    std::cout << "  • Arm / cancel: O(1) list insert / unlink\n";
+    std::cout << "  • Expiry: run() threads advance the wheel; a due slot is queued in one batch\n";
+    std::cout << "  • Waiting: epoll_wait() sleeps exactly until the next deadline\n\n";
+    
+    // --- Part 1: ordering and cancellation
+    std::cout << "--- Three timers, one cancelled ---\n\n";
+    {
+        SimulatedAsio::io_context io("io_TIMERS");
+        SimulatedAsio::steady_timer slow(io, 30ms);
+        SimulatedAsio::steady_timer fast(io, 10ms);
+        SimulatedAsio::steady_timer medium(io, 20ms);
+        
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed_ms = [start]() {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        };
+        slow.async_wait([&]() { std::cout << "  30 ms timer fired at " << elapsed_ms() << " ms\n"; });
+        fast.async_wait([&]() { std::cout << "  10 ms timer fired at " << elapsed_ms() << " ms\n"; });
+        medium.async_wait([&]() { std::cout << "  20 ms timer fired at " << elapsed_ms() << " ms\n"; });
+        
+        if (medium.cancel()) {
+            std::cout << "  20 ms timer cancelled (request completed in time)\n";
+        }
+        io.run();  // Returns once the last armed timer has fired
+    }
+    
+    // --- Part 2: request timeouts at scale
+    constexpr std::size_t kTimers = 1'000'000;
+    constexpr std::size_t kKeepEvery = 100;  // 1% of requests actually time out
+    std::cout << "\n--- " << kTimers << " request timeouts, " << 100 / kKeepEvery
+              << "% of them expire ---\n\n";
+    
+    SimulatedAsio::io_context io("io_TIMEOUTS");
+    const auto base = std::chrono::steady_clock::now();
+    
+    struct TimeoutState {
+        std::vector<std::chrono::steady_clock::time_point> deadline;
+        std::chrono::steady_clock::time_point run_start;
+        std::vector<double> lateness_us;
+    } state;
+    state.deadline.resize(kTimers);
+    state.lateness_us.reserve(kTimers / kKeepEvery);
+    std::vector<SimulatedAsio::timer_id> ids(kTimers);
+    
+    // Deadlines spread over 1..2 s (deterministic LCG), after the setup below
+    uint32_t seed = 12345;
+    auto arm_start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        state.deadline[i] = base + 1000ms + std::chrono::microseconds(seed % 1'000'000);
+        // Two-pointer capture fits std::function's inline buffer: no allocation.
+        // Lateness counts from run() start if setup overran the deadline.
+        ids[i] = io.arm_timer(state.deadline[i], [s = &state, i]() {
+            auto due = std::max(s->deadline[i], s->run_start);
+            s->lateness_us.push_back(std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - due).count());
+        });
+    }
+    auto arm_ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - arm_start).count() / kTimers;
+    
+    // Most requests answer before their timeout
+    std::size_t cancelled = 0;
+    auto cancel_start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        if (i % kKeepEvery != 0 && io.cancel_timer(ids[i])) {
+            ++cancelled;
+        }
+    }
+    auto cancel_ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - cancel_start).count() / cancelled;
+    
+    const std::size_t peak_bytes = io.timer_memory_bytes();
+    const std::size_t pending = io.timers_pending();
+    state.run_start = std::chrono::steady_clock::now();
+    io.run();  // This thread drives every timer; no helper threads
+    
+    std::sort(state.lateness_us.begin(), state.lateness_us.end());
+    const std::size_t fired = state.lateness_us.size();
+    
+    std::cout << "\n" << std::fixed << std::setprecision(1);
+    std::cout << "  Arm:     " << arm_ns << " ns/timer\n";
+    std::cout << "  Cancel:  " << cancel_ns << " ns/timer (" << cancelled << " cancelled)\n";
+    std::cout << "  Memory:  " << peak_bytes / (1024.0 * 1024.0) << " MB for " << kTimers
+              << " timers (" << peak_bytes / kTimers << " bytes each)\n";
+    std::cout << "  Fired:   " << fired << " of " << pending << " still armed\n";
+    if (fired > 0) {
+        std::cout << "  Late by: p50 " << state.lateness_us[fired / 2] / 1000.0
+                  << " ms, p99 " << state.lateness_us[fired * 99 / 100] / 1000.0
+                  << " ms, max " << state.lateness_us.back() / 1000.0 << " ms\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+    
+    std::cout << "\n✓ Timers cost a wheel node, not a thread\n";
+    std::cout << "✓ Cancelling a completed request's timeout is O(1)\n";
+    std::cout << "✓ Expiry is never early; lateness stays within a tick or two\n";
+}
+
 // ============================================================================
 // MAIN FUNCTION
 // ============================================================================
@@ -617,6 +1626,10 @@ int main() {
     demonstrate_run_call_patterns();
     demonstrate_microservice_gateway();
     demonstrate_best_practices();
+#ifdef __linux__
+    demonstrate_reactor_sockets();
+#endif
+    demonstrate_timer_wheel();
     
     std::cout << "\n" << std::string(70, '=') << "\n";
     std::cout << "All demonstrations completed!\n";
@@ -23,6 +23,8 @@
 #include <array>
 #include <functional>
 
+#include "InplaceTask.h"
+
 using namespace std;
 using namespace std::chrono;
 using namespace std::chrono_literals;
@@ -376,7 +378,7 @@ void example_when_any() {
 class ThreadPool {
 private:
     vector<thread> workers;
-    queue<function<void()>> tasks;
+    TaskQueue tasks;  // Move-only InplaceTasks, no per-task heap allocation
     mutex queue_mutex;
     condition_variable condition;
     atomic<bool> stop;
@@ -386,7 +388,7 @@ public:
         for (size_t i = 0; i < num_threads; ++i) {
             workers.emplace_back([this] {
                 while (true) {
-                    function<void()> task;
+                    InplaceTask task;
                     {
                         unique_lock<mutex> lock(queue_mutex);
                         condition.wait(lock, [this] {
@@ -405,23 +407,19 @@ public:
     }
     
     template<class F, class... Args>
-    auto enqueue(F&& f, Args&&... args) -> future<invoke_result_t<F, Args...>> {
-        using return_type = invoke_result_t<F, Args...>;
-        
-        auto task = make_shared<packaged_task<return_type()>>(
-            bind(forward<F>(f), forward<Args>(args)...)
-        );
-        
-        future<return_type> result = task->get_future();
+    auto enqueue(F&& f, Args&&... args) -> future<task_result_t<F, Args...>> {
+        // Callable + pool-allocated promise in one move-only InplaceTask
+        // (replaces make_shared<packaged_task> + bind)
+        auto [task, result] = package_task(forward<F>(f), forward<Args>(args)...);
         {
             lock_guard<mutex> lock(queue_mutex);
             if (stop) {
                 throw runtime_error("enqueue on stopped ThreadPool");
             }
-            tasks.emplace([task]() { (*task)(); });
+            tasks.push(move(task));
         }
         condition.notify_one();
-        return result;
+        return move(result);
     }
     
     ~ThreadPool() {
@@ -6,8 +6,10 @@
 #include <memory>
 #include <variant>
 #include <algorithm>
-#include <queue>
 #include <typeindex>
+#include <thread>
+
+#include "EventLoop.h"
 
 // ===================================================================
 // EVENT-DRIVEN PROGRAMMING: MODERN LAMBDA-BASED APPROACH
@@ -342,30 +344,14 @@ void example_reactive_observable() {
 // 6. EVENT QUEUE WITH LAMBDAS
 // ===================================================================
 
-class EventQueue {
-private:
-    std::queue<std::function<void()>> events;
-    
-public:
-    void post(std::function<void()> event) {
-        events.push(std::move(event));
-    }
-    
-    void process_all() {
-        while (!events.empty()) {
-            auto event = std::move(events.front());
-            events.pop();
-            event();
-        }
-    }
-    
-    size_t size() const { return events.size(); }
-};
+// EventLoop (EventLoop.h) is the event queue: post() is lock-free and
+// thread-safe, poll() runs everything queued without blocking, and run()
+// would instead sleep until events arrive.
 
 void example_event_queue() {
     std::cout << "\n=== 6. EVENT QUEUE WITH LAMBDAS ===" << std::endl;
     
-    EventQueue queue;
+    EventLoop queue;
     
     // Post events as lambdas (no event classes needed!)
     queue.post([]() {
@@ -381,14 +367,23 @@ void example_event_queue() {
         std::cout << "    Event 3: Process data: " << data << std::endl;
     });
     
+    // Posting from another thread needs no extra locking
+    std::thread producer([&queue]() {
+        queue.post([]() {
+            std::cout << "    Event 4: Posted from a worker thread" << std::endl;
+        });
+    });
+    producer.join();
+    
     std::cout << "\nProcessing " << queue.size() << " events:" << std::endl;
-    queue.process_all();
+    queue.poll();
     
     std::cout << "\n✓ ADVANTAGES:" << std::endl;
     std::cout << "  • No event class hierarchy" << std::endl;
     std::cout << "  • Can capture context in closure" << std::endl;
     std::cout << "  • Extremely flexible" << std::endl;
     std::cout << "  • Minimal boilerplate" << std::endl;
+    std::cout << "  • Post from any thread, lock-free" << std::endl;
 }
 
 // ===================================================================
@@ -0,0 +1,389 @@
+// EventLoop.h
+// Single-threaded event loop shared by the event-driven examples
+// (AsioAndModernCppConcurrency, EventDrivenProgramming_Lambdas)
+//
+// WHY NOT "SWAP THE QUEUE, SLEEP 10ms, REPEAT"?
+// - An idle loop still wakes 100 times a second
+// - A handler posted just after the swap waits for the whole sleep, so
+//   every post pays up to 10ms of latency
+// - One mutex guards the queue, so producers contend with each other and
+//   with the loop
+//
+// WHAT'S HERE:
+// - post() from any thread: a lock-free intrusive MPSC queue (MpscQueue.h),
+//   one exchange per post and no mutex
+// - run() blocks in poll() until there is work. A producer writes to a
+//   wake pipe only if the loop is actually asleep.
+// - Handlers drain in batches of max_batch. Due timers and ready fds get
+//   a turn between batches, so a flood of posts cannot starve them.
+// - post_after() timers and on_fd_ready() one-shot fd waits
+// - poll(): runs whatever is ready without blocking (a drop-in for a
+//   plain "process all queued events" queue)
+// - stats(): handlers run, loop iterations, sleeps, wakeups and loop lag
+//   (post-to-run delay of handlers, lateness of timers) as p50/p99/max
+//
+// run() and poll() must not be called from two threads at once; every
+// other member is thread-safe.
+//
+// Requires C++17, POSIX (poll, pipe) and MpscQueue.h.
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "MpscQueue.h"
+
+struct EventLoopStats {
+    uint64_t handlers_run;   // Posted handlers, timers and fd callbacks
+    uint64_t iterations;     // Times around the loop
+    uint64_t sleeps;         // Blocking waits in poll()
+    uint64_t wakeups;        // Wake-pipe writes by other threads
+    double lag_p50_us;       // Bucket upper bound, capped at the max
+    double lag_p99_us;
+    double lag_max_us;
+};
+
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit EventLoop(std::size_t max_batch = 64)
+        : max_batch_(std::max<std::size_t>(1, max_batch)) {
+        if (::pipe(wake_pipe_) != 0) {
+            throw std::runtime_error("EventLoop: pipe() failed");
+        }
+        for (int fd : wake_pipe_) {
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+    }
+
+    ~EventLoop() {
+        while (Node* node = queue_.try_pop()) {
+            delete node;
+        }
+        ::close(wake_pipe_[0]);
+        ::close(wake_pipe_[1]);
+    }
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    void post(std::function<void()> callback) {
+        queue_.push(new Node{std::move(callback), Clock::now()});
+        // seq_cst pairs with the sleeping_ store in wait_for_events(): either
+        // the loop sees this handler or this thread sees the loop asleep
+        queued_.fetch_add(1, std::memory_order_seq_cst);
+        wake();
+    }
+
+    void post_after(Clock::duration delay, std::function<void()> callback) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            timers_.push_back({Clock::now() + delay, timer_seq_++, std::move(callback)});
+            std::push_heap(timers_.begin(), timers_.end(), TimerLater{});
+        }
+        wake();
+    }
+
+    // One-shot: callback runs on the loop once fd is ready for `events`
+    // (POLLIN / POLLOUT), or has an error or hang-up
+    void on_fd_ready(int fd, short events, std::function<void()> callback) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            fd_waits_.push_back({fd, events, std::move(callback)});
+        }
+        wake();
+    }
+
+    // Runs until stop(); sleeps whenever nothing is ready
+    void run() {
+        while (!stopped_.load(std::memory_order_acquire)) {
+            run_queued();
+            run_due_timers();
+            const bool more = queued_.load(std::memory_order_relaxed) != 0;
+            wait_for_events(!more);
+            bump(iterations_);
+        }
+    }
+
+    // Runs everything that is ready now, including handlers posted by those
+    // handlers, and returns how many ran. Never blocks.
+    std::size_t poll() {
+        std::size_t total = 0;
+        for (;;) {
+            std::size_t ran = run_queued();
+            ran += run_due_timers();
+            ran += wait_for_events(false);
+            bump(iterations_);
+            total += ran;
+            if (ran == 0 || stopped_.load(std::memory_order_acquire)) {
+                return total;
+            }
+        }
+    }
+
+    // seq_cst, like post(): pairs with the sleeping_ store in
+    // wait_for_events(), so either the loop sees the stop or wake() sees it
+    // asleep
+    void stop() {
+        stopped_.store(true, std::memory_order_seq_cst);
+        wake();
+    }
+
+    void restart() { stopped_.store(false, std::memory_order_seq_cst); }
+    bool stopped() const { return stopped_.load(std::memory_order_acquire); }
+
+    // Posted handlers not yet run
+    std::size_t size() const { return queued_.load(std::memory_order_relaxed); }
+
+    EventLoopStats stats() const {
+        std::array<uint64_t, kLagBuckets> counts{};
+        uint64_t total = 0;
+        for (std::size_t i = 0; i < kLagBuckets; ++i) {
+            counts[i] = lag_buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        const double max_us = lag_max_ns_.load(std::memory_order_relaxed) / 1000.0;
+        auto percentile = [&](double q) {
+            const uint64_t rank = static_cast<uint64_t>(q * total);
+            uint64_t seen = 0;
+            for (std::size_t i = 0; i < kLagBuckets; ++i) {
+                seen += counts[i];
+                if (seen > rank) {
+                    return static_cast<double>(uint64_t{1} << i) / 1000.0;
+                }
+            }
+            return 0.0;
+        };
+        return {handlers_run_.load(std::memory_order_relaxed),
+                iterations_.load(std::memory_order_relaxed),
+                sleeps_.load(std::memory_order_relaxed),
+                wakeups_.load(std::memory_order_relaxed),
+                std::min(percentile(0.50), max_us), std::min(percentile(0.99), max_us), max_us};
+    }
+
+private:
+    struct Node : MpscNode {
+        Node(std::function<void()> cb, Clock::time_point at)
+            : callback(std::move(cb)), posted(at) {}
+        std::function<void()> callback;
+        Clock::time_point posted;
+    };
+    struct Timer {
+        Clock::time_point when;
+        uint64_t seq;  // FIFO among equal deadlines
+        std::function<void()> callback;
+    };
+    struct TimerLater {
+        bool operator()(const Timer& a, const Timer& b) const {
+            return a.when != b.when ? a.when > b.when : a.seq > b.seq;
+        }
+    };
+    struct FdWait {
+        int fd;
+        short events;
+        std::function<void()> callback;
+    };
+
+    // Bucket i counts lags in [2^(i-1), 2^i) ns
+    static constexpr std::size_t kLagBuckets = 40;
+
+    const std::size_t max_batch_;
+
+    MpscQueue<Node> queue_;  // Popped only by the loop thread
+    std::atomic<std::size_t> queued_{0};
+
+    std::mutex mutex_;  // Timers and fd waits only
+    std::vector<Timer> timers_;  // Min-heap on `when`
+    uint64_t timer_seq_ = 0;
+    std::vector<FdWait> fd_waits_;
+
+    // Loop thread only; kept to avoid an allocation per iteration
+    std::vector<pollfd> pollfds_;
+    std::vector<std::function<void()>> ready_callbacks_;
+
+    int wake_pipe_[2];
+    std::atomic<bool> sleeping_{false};
+    std::atomic<bool> stopped_{false};
+
+    // Written only by the loop thread (relaxed load + store)
+    std::atomic<uint64_t> handlers_run_{0};
+    std::atomic<uint64_t> iterations_{0};
+    std::atomic<uint64_t> sleeps_{0};
+    std::atomic<uint64_t> lag_max_ns_{0};
+    std::array<std::atomic<uint64_t>, kLagBuckets> lag_buckets_{};
+    // Written by producers
+    std::atomic<uint64_t> wakeups_{0};
+
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void record_lag(Clock::duration lag) {
+        const uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(
+            0, std::chrono::duration_cast<std::chrono::nanoseconds>(lag).count()));
+        std::size_t bucket = 0;
+        while (bucket + 1 < kLagBuckets && (uint64_t{1} << bucket) <= ns) {
+            ++bucket;
+        }
+        bump(lag_buckets_[bucket]);
+        if (ns > lag_max_ns_.load(std::memory_order_relaxed)) {
+            lag_max_ns_.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    // Only writes if the loop is (about to be) blocked in poll()
+    void wake() {
+        if (sleeping_.load(std::memory_order_seq_cst) &&
+            sleeping_.exchange(false, std::memory_order_seq_cst)) {
+            const char byte = 1;
+            ssize_t written = ::write(wake_pipe_[1], &byte, 1);
+            (void)written;  // EAGAIN: the pipe already holds a wakeup
+            wakeups_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // At most max_batch_ posted handlers
+    std::size_t run_queued() {
+        std::size_t ran = 0;
+        while (ran < max_batch_ && queued_.load(std::memory_order_acquire) != 0) {
+            Node* node;
+            // queued_ > 0 guarantees a node; a producer may still be linking it
+            while ((node = queue_.try_pop()) == nullptr) {
+                std::this_thread::yield();
+            }
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            record_lag(Clock::now() - node->posted);
+            node->callback();
+            delete node;
+            bump(handlers_run_);
+            ++ran;
+        }
+        return ran;
+    }
+
+    // At most max_batch_ due timers, earliest first
+    std::size_t run_due_timers() {
+        std::size_t ran = 0;
+        while (ran < max_batch_) {
+            Timer timer;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (timers_.empty() || timers_.front().when > Clock::now()) {
+                    break;
+                }
+                std::pop_heap(timers_.begin(), timers_.end(), TimerLater{});
+                timer = std::move(timers_.back());
+                timers_.pop_back();
+            }
+            record_lag(Clock::now() - timer.when);
+            timer.callback();
+            bump(handlers_run_);
+            ++ran;
+        }
+        return ran;
+    }
+
+    // -1 (block indefinitely) when there are no timers. Caller holds mutex_.
+    int ms_until_next_timer_locked() const {
+        if (timers_.empty()) {
+            return -1;
+        }
+        auto until = std::chrono::ceil<std::chrono::milliseconds>(timers_.front().when - Clock::now());
+        return static_cast<int>(std::clamp<int64_t>(until.count(), 0, std::numeric_limits<int>::max()));
+    }
+
+    // Waits for the registered fds or a wakeup, then runs the callbacks of
+    // ready fds. Returns how many ran. block = false just checks; otherwise
+    // it waits until the next timer is due (indefinitely without timers).
+    std::size_t wait_for_events(bool block) {
+        if (block) {
+            // Before the snapshot: a timer or fd wait registered after it
+            // finds sleeping_ set and writes to the pipe
+            sleeping_.store(true, std::memory_order_seq_cst);
+        }
+
+        // The timeout is taken together with the fd snapshot, under the
+        // same lock, so a post_after() either shows up here or wakes us
+        int timeout_ms = 0;
+        std::vector<pollfd>& fds = pollfds_;
+        fds.assign(1, {wake_pipe_[0], POLLIN, 0});
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const FdWait& wait : fd_waits_) {
+                fds.push_back({wait.fd, wait.events, 0});
+            }
+            if (block) {
+                timeout_ms = ms_until_next_timer_locked();
+            }
+        }
+
+        if (block) {
+            if (timeout_ms == 0 || queued_.load(std::memory_order_seq_cst) != 0 ||
+                stopped_.load(std::memory_order_seq_cst)) {
+                timeout_ms = 0;
+            } else {
+                bump(sleeps_);
+            }
+        }
+        const int ready = ::poll(fds.data(), fds.size(), timeout_ms);
+        if (block) {
+            sleeping_.store(false, std::memory_order_seq_cst);
+        }
+        if (ready <= 0) {
+            return 0;
+        }
+
+        if (fds[0].revents != 0) {
+            char drain[64];
+            while (::read(wake_pipe_[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        // Other threads only append, so fd_waits_[i] was polled as fds[i + 1]
+        std::vector<std::function<void()>>& ready_callbacks = ready_callbacks_;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < fd_waits_.size(); ++i) {
+                if (i + 1 < fds.size() && fds[i + 1].revents != 0) {
+                    ready_callbacks.push_back(std::move(fd_waits_[i].callback));
+                } else {
+                    if (kept != i) {
+                        fd_waits_[kept] = std::move(fd_waits_[i]);
+                    }
+                    ++kept;
+                }
+            }
+            fd_waits_.resize(kept);
+        }
+
+        const std::size_t ran = ready_callbacks.size();
+        for (auto& callback : ready_callbacks) {
+            callback();
+            bump(handlers_run_);
+        }
+        ready_callbacks.clear();
+        return ran;
+    }
+};
+
+#endif // EVENT_LOOP_H
@@ -27,6 +27,12 @@
 #include <random>
 #include <iomanip>
 
+#include "InplaceTask.h"
+
+#ifdef THREAD_POOL_BENCH
+#include "PoolBench.h"
+#endif
+
 using namespace std::chrono_literals;
 
 // ============================================================================
@@ -218,31 +224,32 @@ int compute_factorial(int n) {
 // Task queue for thread pool simulation
 class SimpleThreadPool {
     std::vector<std::thread> threads_;
-    std::queue<std::function<void()>> tasks_;
+    TaskQueue tasks_;  // Move-only InplaceTasks, no per-task heap allocation
     std::mutex mutex_;
     std::condition_variable cv_;
     bool stop_ = false;
     
 public:
-    SimpleThreadPool(size_t num_threads) {
+    // verbose = false silences the per-task trace (ThreadPoolBench)
+    SimpleThreadPool(size_t num_threads, bool verbose = true) {
         for (size_t i = 0; i < num_threads; ++i) {
-            threads_.emplace_back([this, i] {
-                std::cout << "  [Worker " << i << "] Started\n";
+            threads_.emplace_back([this, i, verbose] {
+                if (verbose) std::cout << "  [Worker " << i << "] Started\n";
                 while (true) {
-                    std::function<void()> task;
+                    InplaceTask task;
                     {
                         std::unique_lock<std::mutex> lock(mutex_);
                         cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
                         
                         if (stop_ && tasks_.empty()) {
-                            std::cout << "  [Worker " << i << "] Stopping\n";
+                            if (verbose) std::cout << "  [Worker " << i << "] Stopping\n";
                             return;
                         }
                         
                         task = std::move(tasks_.front());
                         tasks_.pop();
                     }
-                    std::cout << "  [Worker " << i << "] Executing task\n";
+                    if (verbose) std::cout << "  [Worker " << i << "] Executing task\n";
                     task();
                 }
             });
@@ -299,11 +306,11 @@ void demonstrate() {
         std::packaged_task<int(int)> task(compute_factorial);
         futures.push_back(task.get_future());
         
-        // Enqueue task to thread pool - use shared_ptr for copy-ability
-        auto task_ptr = std::make_shared<std::packaged_task<int(int)>>(std::move(task));
+        // Enqueue task to thread pool - InplaceTask is move-only, so the
+        // packaged_task moves straight in (no shared_ptr for copy-ability)
         int value = i;
-        pool.enqueue([task_ptr, value]() {
-            (*task_ptr)(value);
+        pool.enqueue([task = std::move(task), value]() mutable {
+            task(value);
         });
     }
     
@@ -520,6 +527,21 @@ void demonstrate() {
 // MAIN FUNCTION
 // ============================================================================
 
+#ifdef THREAD_POOL_BENCH
+
+// ThreadPoolBench links this file for SimpleThreadPool; its main() is in
+// ThreadPoolExamples.cpp
+std::vector<WorkloadResult> bench_simple_thread_pool(const PoolBenchConfig& config) {
+    using packaged_task_examples::SimpleThreadPool;
+    return run_pool_workloads(
+        "SimpleThreadPool",
+        [&config]() { return std::make_unique<SimpleThreadPool>(config.threads, false); },
+        [](SimpleThreadPool& pool, InplaceTask task) { pool.enqueue(std::move(task)); },
+        config);
+}
+
+#else
+
 int main() {
     std::cout << "\n";
     std::cout << "╔════════════════════════════════════════════════════════════════╗\n";
@@ -560,3 +582,5 @@ int main() {
     
     return 0;
 }
+
+#endif  // THREAD_POOL_BENCH
@@ -0,0 +1,441 @@
+// InplaceTask.h
+// Allocation-free, move-only task type shared by the thread pool examples
+// (ThreadPoolExamples, FuturePromiseAsync, StopTokenExample, Cpp17Concurrency)
+//
+// WHY NOT std::function<void()>?
+// - std::function must be copyable, so move-only state (std::promise,
+//   std::packaged_task, std::unique_ptr) has to be wrapped in a shared_ptr
+// - libstdc++ only stores 16 bytes inline; a lambda with three captures
+//   already goes to the heap
+// - So a typical future-returning submit costs 2-3 mallocs
+//
+// WHAT'S HERE:
+// - InplaceTask:     move-only void() callable, 64 bytes of inline storage,
+//                    larger callables go to a pooled block (not malloc),
+//                    over-aligned ones to aligned operator new
+// - TaskBlockPool:   fixed-size block pool with per-thread caches
+// - PoolAllocator:   std allocator over TaskBlockPool (for std::promise state)
+// - RingQueue:       growable ring buffer with a std::queue-like interface;
+//                    unlike std::deque it never frees/reallocates chunks
+// - package_task():  callable + args -> {InplaceTask, std::future}
+//
+// Requires C++17.
+
+#ifndef INPLACE_TASK_H
+#define INPLACE_TASK_H
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// ============================================================================
+// Fixed-size block pool
+// ============================================================================
+
+// Blocks of kBlockSize bytes. Each thread keeps a small free list; blocks
+// move to/from a shared depot in batches, so the depot mutex is taken at
+// most once per kBatch operations. Tasks are typically allocated on the
+// submitting thread and freed on a worker - the batches carry them back.
+class TaskBlockPool {
+public:
+    static constexpr std::size_t kBlockSize = 256;
+
+    static void* allocate(std::size_t bytes) {
+        if (bytes > kBlockSize) {
+            return ::operator new(bytes);
+        }
+
+        LocalCache& cache = local_cache();
+        if (cache.head == nullptr) {
+            refill(cache);
+        }
+        if (cache.head == nullptr) {
+            return ::operator new(kBlockSize);  // Pool is cold: grow it
+        }
+
+        FreeBlock* block = cache.head;
+        cache.head = block->next;
+        --cache.count;
+        return block;
+    }
+
+    static void deallocate(void* ptr, std::size_t bytes) noexcept {
+        if (bytes > kBlockSize) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        LocalCache& cache = local_cache();
+        auto* block = static_cast<FreeBlock*>(ptr);
+        block->next = cache.head;
+        cache.head = block;
+
+        if (++cache.count > kMaxLocal) {
+            release(cache, kBatch);
+        }
+    }
+
+private:
+    static constexpr std::size_t kBatch = 32;
+    static constexpr std::size_t kMaxLocal = 2 * kBatch;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Depot {
+        std::mutex mutex;
+        FreeBlock* head = nullptr;
+    };
+
+    struct LocalCache {
+        FreeBlock* head = nullptr;
+        std::size_t count = 0;
+
+        ~LocalCache() { release(*this, count); }  // Thread exit: hand blocks back
+    };
+
+    static Depot& depot() {
+        // Leaked on purpose: thread_local caches of late-exiting threads may
+        // still return blocks during static destruction
+        static Depot* instance = new Depot;
+        return *instance;
+    }
+
+    static LocalCache& local_cache() {
+        thread_local LocalCache cache;
+        return cache;
+    }
+
+    static void refill(LocalCache& cache) {
+        Depot& d = depot();
+        std::lock_guard<std::mutex> lock(d.mutex);
+        while (d.head != nullptr && cache.count < kBatch) {
+            FreeBlock* block = d.head;
+            d.head = block->next;
+            block->next = cache.head;
+            cache.head = block;
+            ++cache.count;
+        }
+    }
+
+    static void release(LocalCache& cache, std::size_t n) noexcept {
+        if (n == 0 || cache.head == nullptr) {
+            return;
+        }
+
+        // Detach the first n blocks locally, then splice under the lock
+        FreeBlock* first = cache.head;
+        FreeBlock* last = first;
+        std::size_t moved = 1;
+        while (moved < n && last->next != nullptr) {
+            last = last->next;
+            ++moved;
+        }
+        cache.head = last->next;
+        cache.count -= moved;
+
+        Depot& d = depot();
+        std::lock_guard<std::mutex> lock(d.mutex);
+        last->next = d.head;
+        d.head = first;
+    }
+};
+
+// Standard allocator over TaskBlockPool, e.g. for std::promise shared state
+template<typename T>
+struct PoolAllocator {
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    // Pool blocks are only aligned for std::max_align_t
+    T* allocate(std::size_t n) {
+        if constexpr (alignof(T) > alignof(std::max_align_t)) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+        } else {
+            return static_cast<T*>(TaskBlockPool::allocate(n * sizeof(T)));
+        }
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+        if constexpr (alignof(T) > alignof(std::max_align_t)) {
+            ::operator delete(ptr, std::align_val_t{alignof(T)});
+        } else {
+            TaskBlockPool::deallocate(ptr, n * sizeof(T));
+        }
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+// ============================================================================
+// InplaceTask - move-only void() callable with small-buffer storage
+// ============================================================================
+
+class InplaceTask {
+public:
+    static constexpr std::size_t kInlineSize = 64;
+
+    InplaceTask() noexcept = default;
+    InplaceTask(std::nullptr_t) noexcept {}
+
+    template<typename F,
+             typename Fn = std::decay_t<F>,
+             typename = std::enable_if_t<!std::is_same_v<Fn, InplaceTask> &&
+                                         std::is_invocable_v<Fn&>>>
+    InplaceTask(F&& f) {
+        if constexpr (fits_inline<Fn>) {
+            ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+            ops_ = &InlineOps<Fn>::table;
+        } else if constexpr (over_aligned<Fn>) {
+            ::new (static_cast<void*>(storage_)) Fn*(new Fn(std::forward<F>(f)));
+            ops_ = &HeapOps<Fn>::table;
+        } else {
+            void* block = TaskBlockPool::allocate(sizeof(Fn));
+            try {
+                ::new (block) Fn(std::forward<F>(f));
+            } catch (...) {
+                TaskBlockPool::deallocate(block, sizeof(Fn));
+                throw;
+            }
+            ::new (static_cast<void*>(storage_)) Fn*(static_cast<Fn*>(block));
+            ops_ = &PooledOps<Fn>::table;
+        }
+    }
+
+    InplaceTask(InplaceTask&& other) noexcept {
+        take(other);
+    }
+
+    InplaceTask& operator=(InplaceTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    InplaceTask& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    InplaceTask(const InplaceTask&) = delete;
+    InplaceTask& operator=(const InplaceTask&) = delete;
+
+    ~InplaceTask() { reset(); }
+
+    void operator()() { ops_->invoke(storage_); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    void reset() noexcept {
+        if (ops_ != nullptr) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src) noexcept;  // Also destroys src
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    // Moving a task must not throw (queues rely on it), so callables with a
+    // throwing move constructor are stored out of line where moving is a
+    // pointer copy
+    template<typename Fn>
+    static constexpr bool fits_inline =
+        sizeof(Fn) <= kInlineSize &&
+        alignof(Fn) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<Fn>;
+
+    // TaskBlockPool blocks are only aligned for std::max_align_t, so these
+    // go to the (aligned) global operator new instead
+    template<typename Fn>
+    static constexpr bool over_aligned = alignof(Fn) > alignof(std::max_align_t);
+
+    template<typename Fn>
+    struct InlineOps {
+        static void invoke(void* s) { (*static_cast<Fn*>(s))(); }
+        static void move(void* dst, void* src) noexcept {
+            ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        }
+        static void destroy(void* s) noexcept { static_cast<Fn*>(s)->~Fn(); }
+        static constexpr Ops table{&invoke, &move, &destroy};
+    };
+
+    template<typename Fn>
+    struct PooledOps {
+        static Fn* get(void* s) { return *static_cast<Fn**>(s); }
+        static void invoke(void* s) { (*get(s))(); }
+        static void move(void* dst, void* src) noexcept {
+            ::new (dst) Fn*(get(src));
+        }
+        static void destroy(void* s) noexcept {
+            Fn* fn = get(s);
+            fn->~Fn();
+            TaskBlockPool::deallocate(fn, sizeof(Fn));
+        }
+        static constexpr Ops table{&invoke, &move, &destroy};
+    };
+
+    template<typename Fn>
+    struct HeapOps {
+        static void destroy(void* s) noexcept { delete PooledOps<Fn>::get(s); }
+        static constexpr Ops table{&PooledOps<Fn>::invoke, &PooledOps<Fn>::move, &destroy};
+    };
+
+    void take(InplaceTask& other) noexcept {
+        if (other.ops_ != nullptr) {
+            other.ops_->move(storage_, other.storage_);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    const Ops* ops_ = nullptr;
+};
+
+// ============================================================================
+// RingQueue - FIFO ring buffer that reuses its storage
+// ============================================================================
+
+// Drop-in for std::queue<T> in the pools (push/emplace/front/pop/empty/size).
+// Capacity doubles when full and is never given back, so once a pool has
+// seen its peak backlog, push/pop never allocate.
+template<typename T>
+class RingQueue {
+public:
+    explicit RingQueue(std::size_t initial_capacity = 64)
+        : capacity_(round_up_pow2(initial_capacity)),
+          slots_(std::allocator<T>().allocate(capacity_)) {}
+
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    ~RingQueue() {
+        while (!empty()) {
+            pop();
+        }
+        std::allocator<T>().deallocate(slots_, capacity_);
+    }
+
+    bool empty() const noexcept { return head_ == tail_; }
+    std::size_t size() const noexcept { return tail_ - head_; }
+
+    T& front() noexcept { return slots_[head_ & (capacity_ - 1)]; }
+
+    void push(T&& value) { emplace(std::move(value)); }
+    void push(const T& value) { emplace(value); }
+
+    template<typename... Args>
+    T& emplace(Args&&... args) {
+        if (size() == capacity_) {
+            grow();
+        }
+        T* slot = &slots_[tail_ & (capacity_ - 1)];
+        ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+        ++tail_;
+        return *slot;
+    }
+
+    void pop() noexcept {
+        slots_[head_ & (capacity_ - 1)].~T();
+        ++head_;
+    }
+
+private:
+    static std::size_t round_up_pow2(std::size_t n) {
+        std::size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    void grow() {
+        static_assert(std::is_nothrow_move_constructible_v<T>,
+                      "RingQueue relocates elements when it grows");
+
+        std::size_t new_capacity = capacity_ * 2;
+        T* bigger = std::allocator<T>().allocate(new_capacity);
+        std::size_t n = size();
+        for (std::size_t i = 0; i < n; ++i) {
+            T& old = slots_[(head_ + i) & (capacity_ - 1)];
+            ::new (static_cast<void*>(&bigger[i])) T(std::move(old));
+            old.~T();
+        }
+        std::allocator<T>().deallocate(slots_, capacity_);
+
+        slots_ = bigger;
+        capacity_ = new_capacity;
+        head_ = 0;
+        tail_ = n;
+    }
+
+    std::size_t capacity_;
+    T* slots_;
+    std::size_t head_ = 0;  // Monotonic indices, masked on access
+    std::size_t tail_ = 0;
+};
+
+using TaskQueue = RingQueue<InplaceTask>;
+
+// ============================================================================
+// package_task - callable + arguments -> {InplaceTask, std::future}
+// ============================================================================
+
+// Arguments are stored by value and passed as lvalues, like std::bind
+template<typename F, typename... Args>
+using task_result_t = std::invoke_result_t<std::decay_t<F>&, std::decay_t<Args>&...>;
+
+// Replaces make_shared<packaged_task>: the promise is move-only and now
+// lives inside the task itself, and its shared state comes from
+// TaskBlockPool - no global allocation when the captures fit inline.
+template<typename F, typename... Args>
+auto package_task(F&& f, Args&&... args)
+    -> std::pair<InplaceTask, std::future<task_result_t<F, Args...>>> {
+
+    using return_type = task_result_t<F, Args...>;
+
+    std::promise<return_type> promise(std::allocator_arg, PoolAllocator<return_type>{});
+    std::future<return_type> result = promise.get_future();
+
+    InplaceTask task(
+        [promise = std::move(promise),
+         fn = std::forward<F>(f),
+         bound = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            try {
+                if constexpr (std::is_void_v<return_type>) {
+                    std::apply(fn, bound);
+                    promise.set_value();
+                } else {
+                    promise.set_value(std::apply(fn, bound));
+                }
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        });
+
+    return {std::move(task), std::move(result)};
+}
+
+#endif  // INPLACE_TASK_H
@@ -21,6 +21,7 @@
 #include <memory>
 #include <utility>  // std::move, std::forward
 #include <chrono>
+#include <algorithm>
 
 // ===================================================================
 // SECTION 1: LVALUES vs RVALUES
@@ -0,0 +1,89 @@
+// MpscQueue.h
+// Lock-free intrusive multi-producer / single-consumer queue shared by the
+// event loop and the service examples (EventLoop.h, AsioMultipleContexts,
+// MultiThreadedMicroservices)
+//
+// WHY NOT A MUTEX AROUND A std::deque?
+// - Every producer takes the same lock, so producers contend with each
+//   other and with the consumer
+// - A producer preempted while holding the lock stalls everyone behind it
+//
+// WHAT'S HERE:
+// - MpscNode:   base for queued elements; holds the intrusive next link
+// - MpscQueue:  Vyukov's queue. push() from any thread is one exchange on
+//               the tail plus a release store linking the previous node.
+//               try_pop() is for the one consumer thread only.
+//
+// try_pop() can return nullptr while a push is between its exchange and
+// its link, so the queue alone cannot tell "empty" from "not linked yet".
+// Callers keep their own count of pushed-but-not-popped nodes. While that
+// count is above zero, they yield and retry.
+//
+// The queue does not own its nodes: the consumer deletes what it pops,
+// and the owner drains the queue before destroying it.
+//
+// Requires C++17.
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+
+struct MpscNode {
+    std::atomic<MpscNode*> next{nullptr};
+};
+
+// T must derive from MpscNode
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : tail_(&stub_), head_(&stub_) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread
+    void push(T* node) { link(node); }
+
+    // Consumer thread only
+    T* try_pop() {
+        MpscNode* first = head_;
+        MpscNode* next = first->next.load(std::memory_order_acquire);
+        if (first == &stub_) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            head_ = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            head_ = next;
+            return static_cast<T*>(first);
+        }
+        if (first != tail_.load(std::memory_order_acquire)) {
+            return nullptr;  // A push is between its exchange and its link
+        }
+        // `first` is the last node: park the stub behind it so it can go
+        link(&stub_);
+        next = first->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            head_ = next;
+            return static_cast<T*>(first);
+        }
+        return nullptr;
+    }
+
+private:
+    void link(MpscNode* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* prev = tail_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    std::atomic<MpscNode*> tail_;  // Producers exchange this
+    MpscNode* head_;               // Consumer only
+    MpscNode stub_;
+};
+
+#endif // MPSC_QUEUE_H
@@ -15,8 +15,22 @@
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <cctype>
 #include <csignal>
 #include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
 
 #ifdef __linux__
     #include <pthread.h>
@@ -27,56 +41,387 @@
     #include <dbghelp.h>
 #endif
 
+#include "MpscQueue.h"
+
 using namespace std::chrono;
 using namespace std::chrono_literals;
 
 // ============================================================================
-// SECTION 1: Stack Trace and Logging Infrastructure
+// SECTION 1: Stack Trace, Logging and Metrics Infrastructure
 // ============================================================================
 
+// Logger: asynchronous, and lock-free for the threads that log
+// - Each thread writes compact binary records (timestamp, level, thread
+//   name, message bytes) into its own SPSC ring buffer. The caller takes no
+//   lock, does no formatting and no I/O.
+// - A background thread drains all rings every flush interval, or sooner
+//   when a ring is half full. It merges the records by timestamp, formats
+//   them into one buffer and writes that buffer with a single call.
+// - "HH:MM:SS" is formatted once per second, not once per line
+// - A full ring either drops the record (counted in dropped()) or blocks
+//   the caller until the background thread catches up
+// - flush() returns once everything logged before it has been written.
+//   Call it before abort(), which skips the background thread.
 class Logger {
-private:
-    static std::mutex log_mutex_;
+public:
+    enum Level { INFO, WARNING, ERROR, CRITICAL };
+    enum class Overflow { DROP, BLOCK };
     
-    static std::string get_timestamp() {
-        auto now = system_clock::now();
-        auto time = system_clock::to_time_t(now);
-        auto ms = duration_cast<milliseconds>(now.time_since_epoch()) % 1000;
-        
-        std::ostringstream oss;
-        oss << std::put_time(std::localtime(&time), "%H:%M:%S")
-            << '.' << std::setfill('0') << std::setw(3) << ms.count();
-        return oss.str();
+    static void log(Level level, std::string_view message, 
+                   std::string_view thread_name = "") {
+        Backend& b = backend();
+        if (!local_ring(b).write(level, message, thread_name, b)) {
+            b.dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
     }
     
-    static std::string get_thread_id() {
-        std::ostringstream oss;
-        oss << std::this_thread::get_id();
-        return oss.str();
+    static void flush() {
+        Backend& b = backend();
+        std::unique_lock<std::mutex> lock(b.mutex_);
+        const uint64_t generation = ++b.flush_requested_;
+        b.cv_.notify_one();
+        b.flushed_cv_.wait(lock, [&] { return b.flush_done_ >= generation; });
     }
     
-public:
-    enum Level { INFO, WARNING, ERROR, CRITICAL };
+    static void set_overflow(Overflow policy) {
+        backend().overflow_.store(policy, std::memory_order_relaxed);
+    }
     
-    static void log(Level level, const std::string& message, 
-                   const std::string& thread_name = "") {
-        std::lock_guard<std::mutex> lock(log_mutex_);
+    // Rounded up to a power of two; applies to threads that log for the
+    // first time after the call
+    static void set_ring_bytes(size_t bytes) {
+        size_t rounded = kMinRingBytes;
+        while (rounded < bytes) {
+            rounded <<= 1;
+        }
+        backend().ring_bytes_.store(rounded, std::memory_order_relaxed);
+    }
+    
+    // Everything already logged goes to the old stream
+    static void set_output(std::ostream& out) {
+        flush();
+        Backend& b = backend();
+        std::lock_guard<std::mutex> lock(b.mutex_);
+        b.out_ = &out;
+    }
+    
+    static uint64_t dropped() {
+        return backend().dropped_.load(std::memory_order_relaxed);
+    }
+    
+private:
+    struct RecordHeader {
+        uint32_t size;          // Whole record, header included
+        uint8_t level;          // kPadding: skip to the end of the ring
+        uint8_t name_len;
+        uint16_t message_len;
+        int64_t time_ns;        // system_clock since epoch
+    };
+    static_assert(sizeof(RecordHeader) == 16, "records are 16-byte aligned");
+    static constexpr uint8_t kPadding = 0xFF;
+    static constexpr size_t kMaxMessage = 4096;
+    static constexpr size_t kMaxName = 255;  // Fits name_len
+    // A record takes at most a quarter of the ring, and that quarter must
+    // hold the header and the longest name with room left for a message
+    static constexpr size_t kMinRingBytes = 2048;
+    static_assert(kMinRingBytes / 4 > sizeof(RecordHeader) + kMaxName,
+                  "the smallest ring must fit a record with the longest name");
+    
+    // A record as seen by the background thread; the bytes stay valid until
+    // the ring's tail moves past them
+    struct RecordView {
+        int64_t time_ns;
+        Level level;
+        std::string_view name;
+        std::string_view message;
+        const std::string* thread_id;
+    };
+    
+    class Backend;
+    
+    // Single producer (the owning thread), single consumer (the background
+    // thread). head_ and tail_ count bytes and never wrap.
+    class Ring {
+    public:
+        // bytes is a power of two (set_ring_bytes)
+        Ring(size_t bytes, std::string thread_id)
+            : data_(std::max(bytes, kMinRingBytes)), mask_(data_.size() - 1),
+              thread_id_(std::move(thread_id)) {}
         
-        const char* level_str[] = {"INFO", "WARN", "ERROR", "CRIT"};
-        const char* color[] = {"\033[32m", "\033[33m", "\033[31m", "\033[35m"};
-        const char* reset = "\033[0m";
+        bool write(Level level, std::string_view message, std::string_view name, Backend& b) {
+            const size_t capacity = data_.size();
+            name = name.substr(0, kMaxName);
+            const size_t room = capacity / 4 - sizeof(RecordHeader) - name.size();
+            message = message.substr(0, std::min(kMaxMessage, room));
+            const size_t size = (sizeof(RecordHeader) + name.size() + message.size() + 15) & ~size_t{15};
+            
+            uint64_t head = head_.load(std::memory_order_relaxed);
+            const size_t offset = head & mask_;
+            const size_t padding = capacity - offset < size ? capacity - offset : 0;
+            if (!reserve(head, padding + size, b)) {
+                return false;
+            }
+            
+            if (padding != 0) {
+                RecordHeader skip{static_cast<uint32_t>(padding), kPadding, 0, 0, 0};
+                std::memcpy(&data_[offset], &skip, sizeof(skip));
+                head += padding;
+            }
+            
+            char* out = &data_[head & mask_];
+            RecordHeader header{static_cast<uint32_t>(size), static_cast<uint8_t>(level),
+                                static_cast<uint8_t>(name.size()),
+                                static_cast<uint16_t>(message.size()),
+                                duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count()};
+            std::memcpy(out, &header, sizeof(header));
+            std::memcpy(out + sizeof(header), name.data(), name.size());
+            std::memcpy(out + sizeof(header) + name.size(), message.data(), message.size());
+            head += size;
+            head_.store(head, std::memory_order_release);
+            
+            // Don't wait for the next interval if the ring is filling up
+            if (head - cached_tail_ > capacity / 2) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (head - cached_tail_ > capacity / 2) {
+                    b.wake();
+                }
+            }
+            return true;
+        }
         
-        std::cout << "[" << get_timestamp() << "] "
-                  << color[level] << "[" << level_str[level] << "]" << reset
-                  << " [TID:" << get_thread_id().substr(0, 6) << "]";
+        // Background thread: appends the records written so far
+        void collect(std::vector<RecordView>& batch) {
+            uint64_t pos = tail_.load(std::memory_order_relaxed);
+            collected_ = head_.load(std::memory_order_acquire);
+            while (pos < collected_) {
+                const char* in = &data_[pos & mask_];
+                RecordHeader header;
+                std::memcpy(&header, in, sizeof(header));
+                if (header.level != kPadding) {
+                    const char* name = in + sizeof(header);
+                    batch.push_back({header.time_ns, static_cast<Level>(header.level),
+                                     {name, header.name_len},
+                                     {name + header.name_len, header.message_len}, &thread_id_});
+                }
+                pos += header.size;
+            }
+        }
         
-        if (!thread_name.empty()) {
-            std::cout << " [" << thread_name << "]";
+        // Background thread: frees what collect() saw
+        void release() { tail_.store(collected_, std::memory_order_release); }
+        
+        bool drained() const {
+            return tail_.load(std::memory_order_relaxed) == head_.load(std::memory_order_acquire);
+        }
+        
+        std::atomic<bool> retired{false};  // Owning thread has exited
+        
+    private:
+        std::vector<char> data_;
+        const size_t mask_;
+        const std::string thread_id_;
+        
+        alignas(64) std::atomic<uint64_t> head_{0};
+        uint64_t cached_tail_ = 0;          // Producer's last look at tail_
+        alignas(64) std::atomic<uint64_t> tail_{0};
+        uint64_t collected_ = 0;            // Consumer only
+        
+        bool reserve(uint64_t head, size_t need, Backend& b) {
+            const size_t capacity = data_.size();
+            if (head + need - cached_tail_ <= capacity) {
+                return true;
+            }
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            while (head + need - cached_tail_ > capacity) {
+                if (b.overflow_.load(std::memory_order_relaxed) == Overflow::DROP) {
+                    return false;
+                }
+                b.wake();
+                std::this_thread::yield();
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+            }
+            return true;
+        }
+    };
+    
+    class Backend {
+    public:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::condition_variable flushed_cv_;
+        uint64_t flush_requested_ = 0;
+        uint64_t flush_done_ = 0;
+        std::ostream* out_ = &std::cout;
+        std::atomic<Overflow> overflow_{Overflow::BLOCK};
+        std::atomic<size_t> ring_bytes_{size_t{1} << 16};
+        std::atomic<uint64_t> dropped_{0};
+        
+        Backend() : thread_([this] { run(); }) {}
+        
+        ~Backend() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            cv_.notify_one();
+            thread_.join();
+        }
+        
+        std::shared_ptr<Ring> add_ring() {
+            std::ostringstream tid;
+            tid << std::this_thread::get_id();
+            auto ring = std::make_shared<Ring>(ring_bytes_.load(std::memory_order_relaxed),
+                                               tid.str().substr(0, 6));
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings_.push_back(ring);
+            return ring;
+        }
+        
+        // Lock-free; a wakeup lost to a race costs at most one interval
+        void wake() {
+            if (!wake_.exchange(true, std::memory_order_relaxed)) {
+                cv_.notify_one();
+            }
         }
         
-        std::cout << " " << message << "\n";
+    private:
+        static constexpr auto kFlushInterval = 20ms;
+        
+        std::vector<std::shared_ptr<Ring>> rings_;
+        bool stopping_ = false;
+        std::atomic<bool> wake_{false};
+        
+        // Background thread only
+        std::vector<std::shared_ptr<Ring>> snapshot_;
+        std::vector<RecordView> batch_;
+        std::string buffer_;
+        int64_t cached_second_ = -1;
+        char hms_[16] = {};
+        
+        std::thread thread_;  // Last: starts once everything above exists
+        
+        void run() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (;;) {
+                cv_.wait_for(lock, kFlushInterval, [this] {
+                    return stopping_ || flush_requested_ != flush_done_ ||
+                           wake_.load(std::memory_order_relaxed);
+                });
+                wake_.store(false, std::memory_order_relaxed);
+                const uint64_t generation = flush_requested_;
+                const bool stopping = stopping_;
+                snapshot_ = rings_;
+                std::ostream& out = *out_;
+                lock.unlock();
+                
+                drain(out);
+                
+                lock.lock();
+                rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                            [](const std::shared_ptr<Ring>& ring) {
+                                                return ring->retired.load(std::memory_order_acquire) &&
+                                                       ring->drained();
+                                            }),
+                             rings_.end());
+                flush_done_ = generation;
+                flushed_cv_.notify_all();
+                if (stopping) {
+                    return;
+                }
+            }
+        }
+        
+        void drain(std::ostream& out) {
+            batch_.clear();
+            for (auto& ring : snapshot_) {
+                ring->collect(batch_);
+            }
+            // Each ring is already in time order; this interleaves them
+            std::stable_sort(batch_.begin(), batch_.end(),
+                             [](const RecordView& a, const RecordView& b) { return a.time_ns < b.time_ns; });
+            
+            buffer_.clear();
+            for (const RecordView& record : batch_) {
+                format(record);
+            }
+            if (!buffer_.empty()) {
+                out.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+                out.flush();
+            }
+            
+            for (auto& ring : snapshot_) {
+                ring->release();
+            }
+            snapshot_.clear();
+        }
+        
+        void format(const RecordView& record) {
+            static const char* level_str[] = {"INFO", "WARN", "ERROR", "CRIT"};
+            static const char* color[] = {"\033[32m", "\033[33m", "\033[31m", "\033[35m"};
+            
+            const int64_t second = record.time_ns / 1'000'000'000;
+            if (second != cached_second_) {
+                cached_second_ = second;
+                std::time_t time = static_cast<std::time_t>(second);
+                std::tm local{};
+#ifdef _WIN32
+                localtime_s(&local, &time);
+#else
+                localtime_r(&time, &local);
+#endif
+                std::strftime(hms_, sizeof(hms_), "%H:%M:%S", &local);
+            }
+            const int ms = static_cast<int>(record.time_ns / 1'000'000 % 1000);
+            
+            buffer_ += '[';
+            buffer_ += hms_;
+            buffer_ += '.';
+            buffer_ += static_cast<char>('0' + ms / 100);
+            buffer_ += static_cast<char>('0' + ms / 10 % 10);
+            buffer_ += static_cast<char>('0' + ms % 10);
+            buffer_ += "] ";
+            buffer_ += color[record.level];
+            buffer_ += '[';
+            buffer_ += level_str[record.level];
+            buffer_ += "]\033[0m [TID:";
+            buffer_ += *record.thread_id;
+            buffer_ += ']';
+            if (!record.name.empty()) {
+                buffer_ += " [";
+                buffer_ += record.name;
+                buffer_ += ']';
+            }
+            buffer_ += ' ';
+            buffer_ += record.message;
+            buffer_ += '\n';
+        }
+    };
+    
+    // Marks the ring retired when its thread exits (pthread_exit included);
+    // the background thread frees it once drained
+    struct RingHandle {
+        std::shared_ptr<Ring> ring;
+        ~RingHandle() {
+            if (ring) {
+                ring->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+    
+    static Backend& backend() {
+        static Backend instance;
+        return instance;
+    }
+    
+    static Ring& local_ring(Backend& b) {
+        thread_local RingHandle handle;
+        if (!handle.ring) {
+            handle.ring = b.add_ring();
+        }
+        return *handle.ring;
     }
     
+public:
     static std::vector<std::string> capture_stack_trace() {
         std::vector<std::string> frames;
         
@@ -155,7 +500,252 @@ public:
     }
 };
 
-std::mutex Logger::log_mutex_;
+// Metrics: counters, gauges and latency histograms, exported in
+// Prometheus text format
+// - Hot-path updates are a relaxed fetch_add on one of kMetricShards
+//   cache-line-sized shards. Each thread picks its shard once, so
+//   concurrent writers rarely share a line. No locks.
+// - LatencyHistogram is HDR-style log-linear: 16 sub-buckets per power of
+//   two, so any recorded value is reported within 1/16 (6.25%), from 1ns
+//   up to about 73 minutes
+// - MetricsRegistry owns every metric. counter()/gauge()/histogram() are
+//   get-or-create by name and return a reference that stays valid.
+//   Registration takes a mutex, so do it up front, not per event.
+constexpr size_t kMetricShards = 8;
+
+inline size_t metric_shard() {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t shard = next.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+    return shard;
+}
+
+class Counter {
+public:
+    void add(uint64_t n = 1) {
+        shards_[metric_shard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    
+    uint64_t value() const {
+        uint64_t total = 0;
+        for (const Shard& shard : shards_) {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+    
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    Shard shards_[kMetricShards];
+};
+
+class Gauge {
+public:
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+    double value() const { return value_.load(std::memory_order_relaxed); }
+    
+private:
+    std::atomic<double> value_{0.0};
+};
+
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 4;
+    static constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBits;
+    static constexpr int kMaxBits = 42;  // Larger values are clamped
+    static constexpr size_t kBuckets = (kMaxBits - kSubBits + 1) * kSubBuckets;
+    
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        std::vector<uint64_t> buckets;
+        
+        // Highest value in the bucket holding the q-quantile
+        uint64_t quantile(double q) const {
+            if (count == 0) {
+                return 0;
+            }
+            const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * count)));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < buckets.size(); ++i) {
+                seen += buckets[i];
+                if (seen >= rank) {
+                    return bucket_upper(i);
+                }
+            }
+            return bucket_upper(buckets.size() - 1);
+        }
+    };
+    
+    // Nanoseconds for latencies; any non-negative integer otherwise
+    void record(uint64_t value) {
+        Shard& shard = shards_[metric_shard()];
+        shard.counts[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+    }
+    
+    void record(steady_clock::duration d) {
+        record(static_cast<uint64_t>(std::max<int64_t>(0, duration_cast<nanoseconds>(d).count())));
+    }
+    
+    Snapshot snapshot() const {
+        Snapshot snap;
+        snap.buckets.assign(kBuckets, 0);
+        for (const Shard& shard : shards_) {
+            for (size_t i = 0; i < kBuckets; ++i) {
+                const uint64_t n = shard.counts[i].load(std::memory_order_relaxed);
+                snap.buckets[i] += n;
+                snap.count += n;
+            }
+            snap.sum += shard.sum.load(std::memory_order_relaxed);
+        }
+        return snap;
+    }
+    
+    // Values below kSubBuckets get a bucket each; above, bucket
+    // (shift + 1) * 16 + m holds the values whose top five bits are 16 + m
+    static size_t bucket_of(uint64_t value) {
+        value = std::min(value, (uint64_t{1} << kMaxBits) - 1);
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        int top = 63;
+        while (!(value >> top)) {
+            --top;
+        }
+        const int shift = top - kSubBits;
+        return static_cast<size_t>((shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets));
+    }
+    
+    static uint64_t bucket_upper(size_t bucket) {
+        if (bucket < kSubBuckets) {
+            return bucket;
+        }
+        const uint64_t shift = bucket / kSubBuckets - 1;
+        const uint64_t mantissa = kSubBuckets + bucket % kSubBuckets;
+        return ((mantissa + 1) << shift) - 1;
+    }
+    
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> counts[kBuckets] = {};
+        std::atomic<uint64_t> sum{0};
+    };
+    Shard shards_[kMetricShards];
+};
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+    
+    Counter& counter(const std::string& name, const std::string& help) {
+        return *get_or_add(name, help, Kind::COUNTER).counter;
+    }
+    
+    Gauge& gauge(const std::string& name, const std::string& help) {
+        return *get_or_add(name, help, Kind::GAUGE).gauge;
+    }
+    
+    // scale converts recorded values to exported ones (1e-9: ns -> seconds);
+    // help and scale are only used when the histogram is created
+    LatencyHistogram& histogram(const std::string& name, const std::string& help, double scale = 1e-9) {
+        return *get_or_add(name, help, Kind::HISTOGRAM, scale).histogram;
+    }
+    
+    // Histograms are exported as summaries: quantiles, _sum and _count
+    std::string prometheus_text() const {
+        static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+        std::ostringstream out;
+        out << std::setprecision(9);
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& metric : metrics_) {
+            out << "# HELP " << metric->name << " " << metric->help << "\n";
+            switch (metric->kind) {
+                case Kind::COUNTER:
+                    out << "# TYPE " << metric->name << " counter\n"
+                        << metric->name << " " << metric->counter->value() << "\n";
+                    break;
+                case Kind::GAUGE:
+                    out << "# TYPE " << metric->name << " gauge\n"
+                        << metric->name << " " << metric->gauge->value() << "\n";
+                    break;
+                case Kind::HISTOGRAM: {
+                    LatencyHistogram::Snapshot snap = metric->histogram->snapshot();
+                    out << "# TYPE " << metric->name << " summary\n";
+                    for (double q : quantiles) {
+                        out << metric->name << "{quantile=\"" << q << "\"} "
+                            << snap.quantile(q) * metric->scale << "\n";
+                    }
+                    out << metric->name << "_sum " << snap.sum * metric->scale << "\n"
+                        << metric->name << "_count " << snap.count << "\n";
+                    break;
+                }
+            }
+        }
+        return out.str();
+    }
+    
+    // Written to a temporary file and renamed, so a scraper (for example
+    // the node_exporter textfile collector) never reads half a snapshot
+    bool write_prometheus_file(const std::string& path) const {
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            if (!out) {
+                return false;
+            }
+            out << prometheus_text();
+            if (!out) {
+                return false;
+            }
+        }
+        return std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+    
+private:
+    enum class Kind { COUNTER, GAUGE, HISTOGRAM };
+    
+    struct Metric {
+        std::string name;
+        std::string help;
+        Kind kind;
+        double scale = 1.0;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<LatencyHistogram> histogram;
+    };
+    
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Metric>> metrics_;  // Export order = registration order
+    
+    Metric& get_or_add(const std::string& name, const std::string& help, Kind kind, double scale = 1.0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& metric : metrics_) {
+            if (metric->name == name) {
+                if (metric->kind != kind) {
+                    throw std::logic_error("Metric registered with two types: " + name);
+                }
+                return *metric;
+            }
+        }
+        auto metric = std::make_unique<Metric>();
+        metric->name = name;
+        metric->help = help;
+        metric->kind = kind;
+        metric->scale = scale;
+        switch (kind) {
+            case Kind::COUNTER: metric->counter = std::make_unique<Counter>(); break;
+            case Kind::GAUGE: metric->gauge = std::make_unique<Gauge>(); break;
+            case Kind::HISTOGRAM: metric->histogram = std::make_unique<LatencyHistogram>(); break;
+        }
+        metrics_.push_back(std::move(metric));
+        return *metrics_.back();
+    }
+};
 
 // ============================================================================
 // SECTION 2: Thread Type Identification and Exception Policies
@@ -189,6 +779,7 @@ public:
             Logger::log(Logger::CRITICAL, 
                        "CORE SERVICE FAILURE - Calling abort() to terminate application!", 
                        name_);
+            Logger::flush();  // abort() would discard whatever is still queued
             std::cerr << "\n╔════════════════════════════════════════╗\n";
             std::cerr << "║   CRITICAL: CORE SERVICE CRASHED       ║\n";
             std::cerr << "║   Terminating entire application       ║\n";
@@ -199,6 +790,7 @@ public:
             Logger::log(Logger::ERROR, 
                        "REST/MONITORING SERVICE FAILURE - Exiting thread only (core services continue)", 
                        name_);
+            Logger::flush();  // Keep the log ahead of the banner below
             std::cerr << "\n╔════════════════════════════════════════╗\n";
             std::cerr << "║   REST/Monitor thread exiting          ║\n";
             std::cerr << "║   Core services still running OK       ║\n";
@@ -229,95 +821,355 @@ public:
         : std::runtime_error("JSON Parse Error: " + msg) {}
 };
 
+// SimpleJson: the body is parsed once, in the constructor, into a flat
+// tape of byte offsets.
+// - The root object, each top-level key and each top-level value is one
+//   entry. A nested object or array is a single entry spanning its text;
+//   its contents are validated but not recorded.
+// - Top-level keys go into a small open-addressing index, so get_field()
+//   is O(1) and allocates only the std::string it returns. field() returns
+//   a view and allocates nothing.
+// - Parsing validates the whole body; malformed JSON throws
+//   JsonParseException.
 class SimpleJson {
-private:
-    std::string data_;
-    
 public:
-    explicit SimpleJson(const std::string& json_str) : data_(json_str) {
-        validate();
-    }
+    enum class Kind : uint8_t { OBJECT, ARRAY, STRING, NUMBER, LITERAL };
     
-    void validate() const {
-        // Simple validation
+    explicit SimpleJson(std::string json_str) : data_(std::move(json_str)) {
         if (data_.empty()) {
             throw JsonParseException("Empty JSON string");
         }
-        
-        // Must start with { and end with }
-        size_t start = data_.find_first_not_of(" \t\n\r");
-        size_t end = data_.find_last_not_of(" \t\n\r");
-        
-        if (start == std::string::npos || end == std::string::npos) {
+        if (data_.size() >= kNone) {
+            throw JsonParseException("Body too large");
+        }
+        pos_ = skip_whitespace(0);
+        if (pos_ == data_.size()) {
             throw JsonParseException("Invalid JSON: whitespace only");
         }
-        
-        if (data_[start] != '{' || data_[end] != '}') {
+        if (data_[pos_] != '{') {
             throw JsonParseException("Invalid JSON: must start with { and end with }");
         }
-        
-        // Count braces
-        int brace_count = 0;
-        for (char c : data_) {
-            if (c == '{') brace_count++;
-            if (c == '}') brace_count--;
-            if (brace_count < 0) {
-                throw JsonParseException("Invalid JSON: unmatched closing brace");
-            }
+        tape_.reserve(16);
+        parse_value(0);
+        if (skip_whitespace(pos_) != data_.size()) {
+            throw JsonParseException("Invalid JSON: trailing characters after closing brace");
         }
-        
-        if (brace_count != 0) {
-            throw JsonParseException("Invalid JSON: unmatched opening brace");
+        build_index();
+    }
+    
+    // Raw text of a top-level field: string contents without the quotes
+    // (escapes left as written), anything else exactly as in the body
+    std::string_view field(std::string_view field_name) const {
+        const uint32_t value = find(field_name);
+        if (value == kNone) {
+            throw JsonParseException("Field not found: " + std::string(field_name));
         }
+        return text(tape_[value]);
     }
     
     std::string get_field(const std::string& field_name) const {
-        std::string search = "\"" + field_name + "\"";
-        size_t pos = data_.find(search);
-        
-        if (pos == std::string::npos) {
-            throw JsonParseException("Field not found: " + field_name);
+        return std::string(field(field_name));
+    }
+    
+    bool has_field(std::string_view field_name) const { return find(field_name) != kNone; }
+    
+    Kind kind_of(std::string_view field_name) const {
+        const uint32_t value = find(field_name);
+        if (value == kNone) {
+            throw JsonParseException("Field not found: " + std::string(field_name));
         }
-        
-        // Find value after colon
-        size_t colon = data_.find(':', pos);
-        if (colon == std::string::npos) {
-            throw JsonParseException("Malformed field: " + field_name);
+        return tape_[value].kind;
+    }
+    
+    size_t field_count() const { return field_count_; }
+    const std::string& raw() const { return data_; }
+    
+private:
+    struct Token {
+        Kind kind;
+        uint32_t begin;     // Byte offsets into data_; strings exclude quotes
+        uint32_t end;
+        uint32_t next;      // Tape index just past this value (and its contents)
+    };
+    
+    static constexpr uint32_t kNone = UINT32_MAX;
+    static constexpr int kMaxDepth = 64;
+    
+    std::string data_;
+    std::vector<Token> tape_;
+    std::vector<uint32_t> index_;  // Tape index of each top-level key, or kNone
+    size_t field_count_ = 0;
+    size_t pos_ = 0;               // Parse cursor
+    
+    std::string_view text(const Token& token) const {
+        return std::string_view(data_).substr(token.begin, token.end - token.begin);
+    }
+    
+    size_t skip_whitespace(size_t pos) const {
+        while (pos < data_.size() &&
+               (data_[pos] == ' ' || data_[pos] == '\t' || data_[pos] == '\n' || data_[pos] == '\r')) {
+            ++pos;
         }
-        
-        size_t value_start = data_.find_first_not_of(" \t\n\r", colon + 1);
-        size_t value_end = data_.find_first_of(",}", value_start);
-        
-        if (value_start == std::string::npos || value_end == std::string::npos) {
-            throw JsonParseException("Cannot extract value for: " + field_name);
+        return pos;
+    }
+    
+    [[noreturn]] void fail(const char* what) const {
+        throw JsonParseException(std::string("Invalid JSON: ") + what + " at offset " +
+                                 std::to_string(pos_));
+    }
+    
+    char peek() {
+        pos_ = skip_whitespace(pos_);
+        if (pos_ == data_.size()) {
+            fail("unexpected end of input");
+        }
+        return data_[pos_];
+    }
+    
+    size_t digits(size_t pos) const {
+        while (pos < data_.size() && std::isdigit(static_cast<unsigned char>(data_[pos]))) {
+            ++pos;
         }
+        return pos;
+    }
+    
+    // Parses the value at pos_. The root object, its keys and its values
+    // (depth <= 1) become tape entries; anything nested deeper is only
+    // validated, and is covered by its parent's entry.
+    void parse_value(int depth) {
+        const char c = peek();
+        const bool record = depth <= 1;
+        const uint32_t self = static_cast<uint32_t>(tape_.size());
+        const size_t begin = pos_;
+        Kind kind;
         
-        std::string value = data_.substr(value_start, value_end - value_start);
+        if (c == '{' || c == '[') {
+            if (depth == kMaxDepth) {
+                fail("nesting too deep");
+            }
+            const bool object = c == '{';
+            kind = object ? Kind::OBJECT : Kind::ARRAY;
+            if (record) {
+                tape_.push_back({kind, static_cast<uint32_t>(begin), 0, 0});
+            }
+            ++pos_;
+            const char close = object ? '}' : ']';
+            if (peek() != close) {
+                for (;;) {
+                    if (object) {
+                        if (peek() != '"') {
+                            fail("expected a quoted key");
+                        }
+                        parse_value(depth + 1);  // Key
+                        if (peek() != ':') {
+                            fail("expected ':'");
+                        }
+                        ++pos_;
+                    }
+                    parse_value(depth + 1);
+                    const char after = peek();
+                    if (after == ',') {
+                        ++pos_;
+                        continue;
+                    }
+                    if (after != close) {
+                        fail(object ? "expected ',' or '}'" : "expected ',' or ']'");
+                    }
+                    break;
+                }
+            }
+            ++pos_;  // Closing brace or bracket
+            if (record) {
+                tape_[self].end = static_cast<uint32_t>(pos_);
+                tape_[self].next = static_cast<uint32_t>(tape_.size());
+            }
+            return;
+        }
         
-        // Remove quotes if present
-        if (value.front() == '"' && value.back() == '"') {
-            value = value.substr(1, value.length() - 2);
+        size_t token_begin = begin;
+        size_t token_end;
+        if (c == '"') {
+            kind = Kind::STRING;
+            token_begin = ++pos_;
+            const size_t size = data_.size();
+            const char* bytes = data_.data();
+            for (;;) {
+                while (pos_ < size && bytes[pos_] != '"' && bytes[pos_] != '\\' &&
+                       static_cast<unsigned char>(bytes[pos_]) >= 0x20) {
+                    ++pos_;
+                }
+                if (pos_ >= size) {
+                    fail("unterminated string");
+                }
+                if (bytes[pos_] == '"') {
+                    break;
+                }
+                if (bytes[pos_] != '\\') {
+                    fail("control character in string");
+                }
+                pos_ += 2;  // Escape: the next character never ends the string
+            }
+            token_end = pos_++;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            // -?digits(.digits)?([eE][+-]?digits)?
+            kind = Kind::NUMBER;
+            size_t end = digits(pos_ + (c == '-' ? 1 : 0));
+            bool valid = end > begin + (c == '-' ? 1 : 0);
+            if (valid && end < data_.size() && data_[end] == '.') {
+                const size_t fraction = end + 1;
+                end = digits(fraction);
+                valid = end > fraction;
+            }
+            if (valid && end < data_.size() && (data_[end] == 'e' || data_[end] == 'E')) {
+                size_t exponent = end + 1;
+                if (exponent < data_.size() && (data_[exponent] == '+' || data_[exponent] == '-')) {
+                    ++exponent;
+                }
+                end = digits(exponent);
+                valid = end > exponent;
+            }
+            if (!valid) {
+                fail("malformed number");
+            }
+            pos_ = token_end = end;
+        } else {
+            kind = Kind::LITERAL;
+            size_t length = 0;
+            for (const char* literal : {"true", "false", "null"}) {
+                if (data_.compare(pos_, std::strlen(literal), literal) == 0) {
+                    length = std::strlen(literal);
+                    break;
+                }
+            }
+            if (length == 0) {
+                fail("unexpected character");
+            }
+            pos_ = token_end = pos_ + length;
         }
         
-        return value;
+        if (record) {
+            tape_.push_back({kind, static_cast<uint32_t>(token_begin),
+                             static_cast<uint32_t>(token_end), self + 1});
+        }
     }
     
-    const std::string& raw() const { return data_; }
+    // Keys of the root object sit at tape index 1, then after each value
+    void build_index() {
+        for (uint32_t key = 1; key < tape_.size(); key = tape_[key + 1].next) {
+            ++field_count_;
+        }
+        size_t slots = 8;
+        while (slots < field_count_ * 2) {
+            slots <<= 1;
+        }
+        index_.assign(slots, kNone);
+        for (uint32_t key = 1; key < tape_.size(); key = tape_[key + 1].next) {
+            size_t slot = std::hash<std::string_view>{}(text(tape_[key])) & (slots - 1);
+            while (index_[slot] != kNone) {
+                if (text(tape_[index_[slot]]) == text(tape_[key])) {
+                    break;  // Duplicate key: the first one wins
+                }
+                slot = (slot + 1) & (slots - 1);
+            }
+            if (index_[slot] == kNone) {
+                index_[slot] = key;
+            }
+        }
+    }
+    
+    // Tape index of the value of a top-level key, or kNone
+    uint32_t find(std::string_view key) const {
+        const size_t mask = index_.size() - 1;
+        for (size_t slot = std::hash<std::string_view>{}(key) & mask; index_[slot] != kNone;
+             slot = (slot + 1) & mask) {
+            if (text(tape_[index_[slot]]) == key) {
+                return index_[slot] + 1;
+            }
+        }
+        return kNone;
+    }
 };
 
 // ============================================================================
 // SECTION 4: Core Services (Critical - abort on exception)
 // ============================================================================
 
+// DatabaseService runs queries in batches (group commit)
+// - submit_query() appends to a lock-free intrusive MPSC queue (Vyukov):
+//   one exchange, no mutex. The mutex and notify are only used when the
+//   service thread is asleep.
+// - The service thread takes up to max_batch queries, or whatever arrives
+//   within max_wait of the first one, and sends them to the backend as one
+//   unit: one round trip per batch instead of per query
+// - max_batch = 1 gives one query per round trip, like the service
+//   before batching
+// - stats(): queries, batches and a batch-size histogram, reported by
+//   MonitoringService. Queue wait, batch time and batch size also go to
+//   the metrics registry.
+struct DatabaseConfig {
+    size_t max_batch = 64;
+    microseconds max_wait{200};
+    microseconds round_trip = 50ms;   // Simulated backend latency per batch
+    microseconds per_query{100};      // Simulated backend work per query
+};
+
+struct DatabaseStats {
+    // Bucket i counts batches of [2^i, 2^(i+1)) queries; the last is open-ended
+    static constexpr size_t kBuckets = 8;
+    
+    uint64_t queries;
+    uint64_t batches;
+    uint64_t batch_sizes[kBuckets];
+};
+
 class DatabaseService {
 private:
+    struct Query {
+        std::string sql;
+        std::function<void(const std::string&)> on_result;  // May be empty
+        steady_clock::time_point submitted;
+    };
+    
+    struct Node : MpscNode {
+        explicit Node(Query q) : query(std::move(q)) {}
+        Query query;
+    };
+    
+    const DatabaseConfig config_;
     std::atomic<bool> running_{false};
     std::atomic<int> query_count_{0};
+    std::atomic<uint64_t> batch_count_{0};
+    std::atomic<uint64_t> batch_sizes_[DatabaseStats::kBuckets] = {};
+    
+    MpscQueue<Node> queue_;  // Popped only by the service thread
+    std::atomic<size_t> pending_{0};
+    
+    // Sleep/wake only
     std::mutex mutex_;
     std::condition_variable cv_;
-    std::queue<std::string> query_queue_;
+    std::atomic<bool> sleeping_{false};
+    
+    Counter& queries_metric_ = MetricsRegistry::instance().counter(
+        "db_queries_total", "Queries executed");
+    Counter& batches_metric_ = MetricsRegistry::instance().counter(
+        "db_batches_total", "Batches sent to the backend (round trips)");
+    LatencyHistogram& queue_wait_ = MetricsRegistry::instance().histogram(
+        "db_queue_wait_seconds", "Time from submit_query until the query's batch starts");
+    LatencyHistogram& batch_time_ = MetricsRegistry::instance().histogram(
+        "db_batch_seconds", "Backend time per batch");
+    LatencyHistogram& batch_size_ = MetricsRegistry::instance().histogram(
+        "db_batch_size", "Queries per batch", 1.0);
     
 public:
+    explicit DatabaseService(DatabaseConfig config = {})
+        : config_(config) {}
+    
+    ~DatabaseService() {
+        while (Node* node = queue_.try_pop()) {
+            delete node;
+        }
+    }
+    
     void start() {
         running_ = true;
         
@@ -327,71 +1179,352 @@ public:
         Logger::log(Logger::INFO, "Database service started", "DatabaseService");
         
         try {
+            std::vector<Query> batch;
             while (running_) {
-                std::unique_lock<std::mutex> lock(mutex_);
-                cv_.wait_for(lock, 500ms, [this] { 
-                    return !query_queue_.empty() || !running_; 
-                });
-                
-                if (!running_) break;
-                
-                while (!query_queue_.empty()) {
-                    std::string query = query_queue_.front();
-                    query_queue_.pop();
-                    lock.unlock();
-                    
-                    execute_query(query);
-                    
-                    lock.lock();
+                if (!collect_batch(batch)) {
+                    continue;
+                }
+                const auto started = steady_clock::now();
+                for (const Query& query : batch) {
+                    queue_wait_.record(started - query.submitted);
                 }
+                std::vector<std::string> rows = execute_batch(batch);
+                batch_time_.record(steady_clock::now() - started);
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    if (batch[i].on_result) {
+                        batch[i].on_result(rows[i]);
+                    }
+                }
+                batch.clear();
+            }
+        }
+        catch (const std::exception& e) {
+            g_thread_context->handle_exception(e);
+        }
+        
+        Logger::log(Logger::INFO, "Database service stopped", "DatabaseService");
+    }
+    
+    // One round trip for the whole batch; rows[i] answers batch[i]
+    std::vector<std::string> execute_batch(const std::vector<Query>& batch) {
+        // Simulate query execution
+        std::this_thread::sleep_for(config_.round_trip + config_.per_query * batch.size());
+        record_batch(batch.size());
+        
+        std::vector<std::string> rows;
+        rows.reserve(batch.size());
+        for (const Query& query : batch) {
+            const int number = ++query_count_;
+            Logger::log(Logger::INFO, 
+                       "Executed query #" + std::to_string(number) + ": " + query.sql,
+                       "DatabaseService");
+            
+            // Simulate critical error in core service (triggered by special query)
+            if (query.sql.find("TRIGGER_CORE_FAILURE") != std::string::npos) {
+                Logger::log(Logger::ERROR, 
+                           "⚠️  SIMULATING CRITICAL DATABASE CORRUPTION!", 
+                           "DatabaseService");
+                std::this_thread::sleep_for(100ms);
+                throw std::runtime_error("CRITICAL: Database corruption detected! Data integrity compromised!");
+            }
+            rows.push_back("rows(" + query.sql + ")");
+        }
+        return rows;
+    }
+    
+    // on_result runs on the database thread with the query's rows
+    void submit_query(const std::string& query,
+                      std::function<void(const std::string&)> on_result = {}) {
+        queue_.push(new Node{{query, std::move(on_result), steady_clock::now()}});
+        // seq_cst pairs with the sleeping_ store in wait_for_work()
+        pending_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_seq_cst) &&
+            sleeping_.exchange(false, std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_one();
+        }
+    }
+    
+    void stop() {
+        running_ = false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_all();
+    }
+    
+    int get_query_count() const { return query_count_.load(); }
+    
+    DatabaseStats stats() const {
+        DatabaseStats stats{static_cast<uint64_t>(query_count_.load()), batch_count_.load(), {}};
+        for (size_t i = 0; i < DatabaseStats::kBuckets; ++i) {
+            stats.batch_sizes[i] = batch_sizes_[i].load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+    
+private:
+    void record_batch(size_t size) {
+        size_t bucket = 0;
+        while (bucket + 1 < DatabaseStats::kBuckets && (size_t{2} << bucket) <= size) {
+            ++bucket;
+        }
+        batch_sizes_[bucket].fetch_add(1, std::memory_order_relaxed);
+        batch_count_.fetch_add(1, std::memory_order_relaxed);
+        batch_size_.record(size);
+        batches_metric_.add();
+        queries_metric_.add(size);
+    }
+    
+    // Fills `batch`: blocks for the first query, then takes more until
+    // max_batch or max_wait. False if stopped while waiting.
+    bool collect_batch(std::vector<Query>& batch) {
+        if (!wait_for_work()) {
+            return false;
+        }
+        const auto deadline = steady_clock::now() + config_.max_wait;
+        while (batch.size() < config_.max_batch) {
+            if (pending_.load(std::memory_order_acquire) == 0) {
+                if (steady_clock::now() >= deadline) {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+            Node* node;
+            // pending_ > 0 guarantees a node; a producer may still be linking it
+            while ((node = queue_.try_pop()) == nullptr) {
+                std::this_thread::yield();
             }
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            batch.push_back(std::move(node->query));
+            delete node;
         }
-        catch (const std::exception& e) {
-            g_thread_context->handle_exception(e);
+        return true;
+    }
+    
+    // True once a query is queued; false if the service was stopped
+    bool wait_for_work() {
+        while (running_) {
+            if (pending_.load(std::memory_order_acquire) != 0) {
+                return true;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleeping_.store(true, std::memory_order_seq_cst);
+            if (pending_.load(std::memory_order_seq_cst) == 0 && running_) {
+                cv_.wait_for(lock, 500ms);
+            }
+            sleeping_.store(false, std::memory_order_seq_cst);
         }
-        
-        Logger::log(Logger::INFO, "Database service stopped", "DatabaseService");
+        return false;
     }
+};
+
+// ShardedCache: string -> string cache with a byte budget and a TTL
+// - Keys hash to one of N shards, each with its own std::shared_mutex,
+//   hash map and byte budget (total / N)
+// - Eviction is CLOCK rather than strict LRU. A hit only sets the entry's
+//   atomic reference bit, so the hit path holds the shard's lock in shared
+//   mode and readers never block each other.
+// - Inserting over budget sweeps the clock hand under the exclusive lock.
+//   Expired entries go first; referenced entries get a second chance.
+// - Expired entries read as misses and are reclaimed by the sweep
+struct CacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;    // Removed to make room
+    uint64_t expirations;  // Removed because their TTL had passed
+    uint64_t entries;
+    uint64_t bytes;
+};
+
+class ShardedCache {
+public:
+    using Clock = steady_clock;
     
-    void execute_query(const std::string& query) {
-        query_count_++;
-        
-        // Simulate query execution
-        std::this_thread::sleep_for(50ms);
+    ShardedCache(size_t shard_count, size_t byte_budget, Clock::duration ttl)
+        : shards_(round_up_pow2(shard_count)),
+          shard_budget_(byte_budget / round_up_pow2(shard_count)),
+          ttl_(ttl) {}
+    
+    std::optional<std::string> get(const std::string& key) {
+        Shard& shard = shard_for(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Slot& slot = shard.slots[it->second];
+            if (Clock::now() < slot.expires) {
+                if (!slot.referenced.load(std::memory_order_relaxed)) {
+                    slot.referenced.store(true, std::memory_order_relaxed);
+                }
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+                return slot.value;
+            }
+        }
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    
+    // Values larger than a shard's budget are not cached
+    void put(const std::string& key, std::string value) {
+        const size_t bytes = entry_bytes(key, value);
+        Shard& shard = shard_for(key);
+        if (bytes > shard_budget_) {
+            return;
+        }
         
-        Logger::log(Logger::INFO, 
-                   "Executed query #" + std::to_string(query_count_.load()) + ": " + query,
-                   "DatabaseService");
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        const Clock::time_point now = Clock::now();
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Slot& slot = shard.slots[it->second];
+            shard.bytes = shard.bytes - slot.bytes + bytes;
+            slot.value = std::move(value);
+            slot.bytes = bytes;
+            slot.expires = now + ttl_;
+            make_room(shard, 0, now, it->second);
+            return;
+        }
         
-        // Simulate critical error in core service (triggered by special query)
-        if (query.find("TRIGGER_CORE_FAILURE") != std::string::npos) {
-            Logger::log(Logger::ERROR, 
-                       "⚠️  SIMULATING CRITICAL DATABASE CORRUPTION!", 
-                       "DatabaseService");
-            std::this_thread::sleep_for(100ms);
-            throw std::runtime_error("CRITICAL: Database corruption detected! Data integrity compromised!");
+        make_room(shard, bytes, now, kNoSlot);
+        uint32_t index;
+        if (!shard.free.empty()) {
+            index = shard.free.back();
+            shard.free.pop_back();
+        } else {
+            index = static_cast<uint32_t>(shard.slots.size());
+            shard.slots.emplace_back();
         }
+        Slot& slot = shard.slots[index];
+        slot.key = key;
+        slot.value = std::move(value);
+        slot.bytes = bytes;
+        slot.expires = now + ttl_;
+        slot.used = true;
+        slot.referenced.store(false, std::memory_order_relaxed);
+        shard.index.emplace(key, index);
+        shard.bytes += bytes;
     }
     
-    void submit_query(const std::string& query) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        query_queue_.push(query);
-        cv_.notify_one();
+    CacheStats stats() const {
+        CacheStats total{};
+        for (const Shard& shard : shards_) {
+            total.hits += shard.hits.load(std::memory_order_relaxed);
+            total.misses += shard.misses.load(std::memory_order_relaxed);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            total.evictions += shard.evictions;
+            total.expirations += shard.expirations;
+            total.entries += shard.index.size();
+            total.bytes += shard.bytes;
+        }
+        return total;
     }
     
-    void stop() {
-        running_ = false;
-        cv_.notify_all();
+private:
+    struct Slot {
+        std::string key;
+        std::string value;
+        size_t bytes = 0;
+        Clock::time_point expires;
+        bool used = false;
+        std::atomic<bool> referenced{false};  // Set by readers under the shared lock
+    };
+    
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, uint32_t> index;
+        std::deque<Slot> slots;     // Deque: slots never move once created
+        std::vector<uint32_t> free;
+        size_t hand = 0;
+        size_t bytes = 0;
+        uint64_t evictions = 0;     // Exclusive lock only
+        uint64_t expirations = 0;
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+    };
+    
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+    
+    std::vector<Shard> shards_;
+    const size_t shard_budget_;
+    const Clock::duration ttl_;
+    
+    static size_t round_up_pow2(size_t n) {
+        size_t rounded = 1;
+        while (rounded < n) {
+            rounded <<= 1;
+        }
+        return rounded;
     }
     
-    int get_query_count() const { return query_count_.load(); }
+    // Rough heap footprint: both strings plus node and slot overhead
+    static size_t entry_bytes(const std::string& key, const std::string& value) {
+        return 2 * key.size() + value.size() + sizeof(Slot) + 32;
+    }
+    
+    Shard& shard_for(const std::string& key) {
+        // High bits: the map inside the shard uses the low ones
+        const size_t hash = std::hash<std::string>{}(key);
+        return shards_[(hash >> 48) & (shards_.size() - 1)];
+    }
+    
+    // Sweeps the clock hand until `incoming` more bytes fit; `keep` is the
+    // slot being updated and is never evicted
+    void make_room(Shard& shard, size_t incoming, Clock::time_point now, uint32_t keep) {
+        // Two full turns clear every reference bit, so this terminates
+        size_t budget_steps = 2 * shard.slots.size() + 1;
+        while (shard.bytes + incoming > shard_budget_ && budget_steps-- > 0) {
+            if (shard.hand >= shard.slots.size()) {
+                shard.hand = 0;
+            }
+            const uint32_t index = static_cast<uint32_t>(shard.hand++);
+            Slot& slot = shard.slots[index];
+            if (!slot.used || index == keep) {
+                continue;
+            }
+            const bool expired = slot.expires <= now;
+            if (!expired && slot.referenced.exchange(false, std::memory_order_relaxed)) {
+                continue;  // Second chance
+            }
+            ++(expired ? shard.expirations : shard.evictions);
+            shard.bytes -= slot.bytes;
+            shard.index.erase(slot.key);
+            slot.used = false;
+            std::string().swap(slot.key);
+            std::string().swap(slot.value);
+            shard.free.push_back(index);
+        }
+    }
 };
 
 class CacheService {
 private:
     std::atomic<bool> running_{false};
-    std::atomic<int> cache_hits_{0};
-    std::atomic<int> cache_misses_{0};
+    ShardedCache cache_{16, size_t{1} << 20, 30s};
+    
+    LatencyHistogram& get_time_ = MetricsRegistry::instance().histogram(
+        "cache_get_seconds", "CacheService::get latency");
+    Counter& hits_metric_ = MetricsRegistry::instance().counter("cache_hits_total", "Cache hits");
+    Counter& misses_metric_ = MetricsRegistry::instance().counter("cache_misses_total", "Cache misses");
+    Counter& evictions_metric_ = MetricsRegistry::instance().counter(
+        "cache_evictions_total", "Entries evicted to make room");
+    Counter& expirations_metric_ = MetricsRegistry::instance().counter(
+        "cache_expirations_total", "Entries reclaimed after their TTL");
+    Gauge& hit_ratio_ = MetricsRegistry::instance().gauge(
+        "cache_hit_ratio", "Hits / lookups since start");
+    Gauge& entries_ = MetricsRegistry::instance().gauge("cache_entries", "Entries cached");
+    Gauge& bytes_ = MetricsRegistry::instance().gauge("cache_bytes", "Approximate bytes cached");
+    
+    // The cache keeps its own counters; the metrics get the deltas
+    void publish(const CacheStats& stats, const CacheStats& last) {
+        hits_metric_.add(stats.hits - last.hits);
+        misses_metric_.add(stats.misses - last.misses);
+        evictions_metric_.add(stats.evictions - last.evictions);
+        expirations_metric_.add(stats.expirations - last.expirations);
+        if (stats.hits + stats.misses > 0) {
+            hit_ratio_.set(static_cast<double>(stats.hits) / (stats.hits + stats.misses));
+        }
+        entries_.set(static_cast<double>(stats.entries));
+        bytes_.set(static_cast<double>(stats.bytes));
+    }
     
 public:
     void start() {
@@ -403,18 +1536,22 @@ public:
         Logger::log(Logger::INFO, "Cache service started", "CacheService");
         
         try {
+            CacheStats last{};
             while (running_) {
                 std::this_thread::sleep_for(1s);
                 
-                // Simulate cache maintenance
-                if (cache_hits_ + cache_misses_ > 0) {
-                    int total = cache_hits_ + cache_misses_;
-                    float hit_rate = (100.0f * cache_hits_) / total;
+                CacheStats stats = cache_.stats();
+                publish(stats, last);
+                last = stats;
+                if (stats.hits + stats.misses > 0) {
+                    float hit_rate = (100.0f * stats.hits) / (stats.hits + stats.misses);
                     
                     std::ostringstream oss;
-                    oss << "Cache stats: " << cache_hits_.load() << " hits, "
-                        << cache_misses_.load() << " misses (hit rate: "
-                        << std::fixed << std::setprecision(1) << hit_rate << "%)";
+                    oss << "Cache stats: " << stats.hits << " hits, "
+                        << stats.misses << " misses (hit rate: "
+                        << std::fixed << std::setprecision(1) << hit_rate << "%), "
+                        << stats.entries << " entries, " << stats.bytes << " bytes, "
+                        << stats.evictions << " evicted, " << stats.expirations << " expired";
                     
                     Logger::log(Logger::INFO, oss.str(), "CacheService");
                 }
@@ -427,19 +1564,19 @@ public:
         Logger::log(Logger::INFO, "Cache service stopped", "CacheService");
     }
     
-    bool get(const std::string& key) {
-        // Simulate cache lookup
-        bool hit = (std::hash<std::string>{}(key) % 3) == 0;
-        
-        if (hit) {
-            cache_hits_++;
-        } else {
-            cache_misses_++;
-        }
-        
-        return hit;
+    std::optional<std::string> get(const std::string& key) {
+        const auto start = steady_clock::now();
+        std::optional<std::string> value = cache_.get(key);
+        get_time_.record(steady_clock::now() - start);
+        return value;
+    }
+    
+    void put(const std::string& key, std::string value) {
+        cache_.put(key, std::move(value));
     }
     
+    CacheStats stats() const { return cache_.stats(); }
+    
     void stop() {
         running_ = false;
     }
@@ -457,6 +1594,13 @@ private:
     DatabaseService& db_;
     CacheService& cache_;
     
+    Counter& requests_metric_ = MetricsRegistry::instance().counter(
+        "rest_requests_total", "REST requests received");
+    Counter& errors_metric_ = MetricsRegistry::instance().counter(
+        "rest_errors_total", "REST requests rejected");
+    LatencyHistogram& request_time_ = MetricsRegistry::instance().histogram(
+        "rest_request_seconds", "REST request service time (parse, cache, submit)");
+    
 public:
     RestApiService(DatabaseService& db, CacheService& cache)
         : db_(db), cache_(cache) {}
@@ -498,16 +1642,20 @@ public:
             
             const std::string& request_body = requests[request_num];
             request_count_++;
+            requests_metric_.add();
             
             Logger::log(Logger::INFO, 
                        "Received REST request #" + std::to_string(request_count_.load()),
                        "RestApiService");
             
             try {
+                const auto start = steady_clock::now();
                 handle_request(request_body);
+                request_time_.record(steady_clock::now() - start);
             }
             catch (const JsonParseException& e) {
                 error_count_++;
+                errors_metric_.add();
                 
                 Logger::log(Logger::ERROR, 
                            "Invalid JSON in request #" + std::to_string(request_count_.load()),
@@ -534,13 +1682,15 @@ public:
         
         Logger::log(Logger::INFO, "Processing action: " + action, "RestApiService");
         
-        // Check cache
+        // Check cache; only misses reach the database thread, which fills
+        // the cache with the result
         if (cache_.get(action)) {
             Logger::log(Logger::INFO, "Cache HIT for action: " + action, "RestApiService");
         } else {
             Logger::log(Logger::INFO, "Cache MISS for action: " + action, "RestApiService");
-            // Submit query to database
-            db_.submit_query("SELECT * FROM actions WHERE action='" + action + "'");
+            CacheService& cache = cache_;
+            db_.submit_query("SELECT * FROM actions WHERE action='" + action + "'",
+                             [&cache, action](const std::string& rows) { cache.put(action, rows); });
         }
     }
     
@@ -556,15 +1706,35 @@ public:
 // SECTION 6: Monitoring Service (Non-critical)
 // ============================================================================
 
+// Every 2s: logs a health line, the DB batch histogram and the tail
+// latencies, and writes all metrics to metrics_path in Prometheus text
+// format
 class MonitoringService {
 private:
     std::atomic<bool> running_{false};
     DatabaseService& db_;
     RestApiService& rest_;
+    std::string metrics_path_;
+    
+    // Registered by the services, which are constructed first
+    const LatencyHistogram& rest_request_time_ = MetricsRegistry::instance().histogram(
+        "rest_request_seconds", "REST request service time (parse, cache, submit)");
+    const LatencyHistogram& db_queue_wait_ = MetricsRegistry::instance().histogram(
+        "db_queue_wait_seconds", "Time from submit_query until the query's batch starts");
+    const LatencyHistogram& db_batch_time_ = MetricsRegistry::instance().histogram(
+        "db_batch_seconds", "Backend time per batch");
+    
+    static std::string tail(const std::string& label, const LatencyHistogram& histogram) {
+        LatencyHistogram::Snapshot snap = histogram.snapshot();
+        std::ostringstream oss;
+        oss << label << " p50=" << snap.quantile(0.5) / 1000 << "µs p99="
+            << snap.quantile(0.99) / 1000 << "µs";
+        return oss.str();
+    }
     
 public:
-    MonitoringService(DatabaseService& db, RestApiService& rest)
-        : db_(db), rest_(rest) {}
+    MonitoringService(DatabaseService& db, RestApiService& rest, std::string metrics_path)
+        : db_(db), rest_(rest), metrics_path_(std::move(metrics_path)) {}
     
     void start() {
         running_ = true;
@@ -572,9 +1742,12 @@ public:
         g_thread_context = std::make_unique<ThreadContext>(
             ThreadType::MONITORING, "MonitoringService");
         
-        Logger::log(Logger::INFO, "Monitoring service started", "MonitoringService");
+        Logger::log(Logger::INFO, "Monitoring service started, exporting metrics to " + metrics_path_,
+                    "MonitoringService");
         
         try {
+            DatabaseStats last = db_.stats();
+            auto last_time = steady_clock::now();
             while (running_) {
                 std::this_thread::sleep_for(2s);
                 
@@ -584,6 +1757,22 @@ public:
                     << ", REST errors=" << rest_.get_error_count();
                 
                 Logger::log(Logger::INFO, oss.str(), "MonitoringService");
+                
+                DatabaseStats now = db_.stats();
+                auto now_time = steady_clock::now();
+                Logger::log(Logger::INFO, format_db_stats(last, now, now_time - last_time),
+                            "MonitoringService");
+                last = now;
+                last_time = now_time;
+                
+                Logger::log(Logger::INFO,
+                            tail("Tail latency: REST", rest_request_time_) + ", " +
+                            tail("DB queue wait", db_queue_wait_) + ", " +
+                            tail("DB batch", db_batch_time_),
+                            "MonitoringService");
+                if (!MetricsRegistry::instance().write_prometheus_file(metrics_path_)) {
+                    Logger::log(Logger::WARNING, "Cannot write " + metrics_path_, "MonitoringService");
+                }
             }
         }
         catch (const std::exception& e) {
@@ -596,6 +1785,32 @@ public:
     void stop() {
         running_ = false;
     }
+    
+    // "DB throughput=X q/s, batches=N, batch sizes: 1:a 2-3:b ..." for the
+    // interval between two snapshots (empty buckets omitted)
+    static std::string format_db_stats(const DatabaseStats& before, const DatabaseStats& after,
+                                       steady_clock::duration interval) {
+        std::ostringstream oss;
+        const double seconds = duration<double>(interval).count();
+        oss << "DB throughput=" << std::fixed << std::setprecision(1)
+            << (after.queries - before.queries) / seconds << " q/s, batches="
+            << after.batches - before.batches << ", batch sizes:";
+        for (size_t i = 0; i < DatabaseStats::kBuckets; ++i) {
+            const uint64_t count = after.batch_sizes[i] - before.batch_sizes[i];
+            if (count == 0) {
+                continue;
+            }
+            const size_t low = size_t{1} << i;
+            oss << " " << low;
+            if (i + 1 == DatabaseStats::kBuckets) {
+                oss << "+";
+            } else if (low > 1) {
+                oss << "-" << (low * 2 - 1);
+            }
+            oss << ":" << count;
+        }
+        return oss.str();
+    }
 };
 
 // ============================================================================
@@ -615,7 +1830,8 @@ private:
 public:
     MicroservicesOrchestrator(bool simulate_core_failure = false)
         : rest_service_(db_service_, cache_service_),
-          monitoring_service_(db_service_, rest_service_),
+          monitoring_service_(db_service_, rest_service_,
+                              (std::filesystem::temp_directory_path() / "microservices_metrics.prom").string()),
           simulate_core_failure_(simulate_core_failure) {}
     
     void start() {
@@ -777,6 +1993,434 @@ void demonstrate_best_practices() {
     std::cout << "  5. Consider std::terminate() as alternative to abort()\n";
 }
 
+// ============================================================================
+// SECTION 9: Logger Benchmark
+// ============================================================================
+
+// The synchronous logger Logger replaced, kept for comparison: one global
+// mutex, localtime + put_time and an ostringstream per line, written on the
+// calling thread
+class MutexLogger {
+private:
+    static std::mutex log_mutex_;
+    static std::ostream* out_;
+    
+    static std::string get_timestamp() {
+        auto now = system_clock::now();
+        auto time = system_clock::to_time_t(now);
+        auto ms = duration_cast<milliseconds>(now.time_since_epoch()) % 1000;
+        
+        std::ostringstream oss;
+        oss << std::put_time(std::localtime(&time), "%H:%M:%S")
+            << '.' << std::setfill('0') << std::setw(3) << ms.count();
+        return oss.str();
+    }
+    
+    static std::string get_thread_id() {
+        std::ostringstream oss;
+        oss << std::this_thread::get_id();
+        return oss.str();
+    }
+    
+public:
+    static void set_output(std::ostream& out) { out_ = &out; }
+    
+    static void log(Logger::Level level, const std::string& message, 
+                   const std::string& thread_name = "") {
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        
+        const char* level_str[] = {"INFO", "WARN", "ERROR", "CRIT"};
+        const char* color[] = {"\033[32m", "\033[33m", "\033[31m", "\033[35m"};
+        const char* reset = "\033[0m";
+        
+        *out_ << "[" << get_timestamp() << "] "
+              << color[level] << "[" << level_str[level] << "]" << reset
+              << " [TID:" << get_thread_id().substr(0, 6) << "]";
+        
+        if (!thread_name.empty()) {
+            *out_ << " [" << thread_name << "]";
+        }
+        
+        *out_ << " " << message << "\n";
+    }
+};
+
+std::mutex MutexLogger::log_mutex_;
+std::ostream* MutexLogger::out_ = &std::cout;
+
+// Formats everything, writes nothing: measures the loggers, not the terminal
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// Seconds until every thread has made all its calls
+template<typename LogCall>
+double time_log_calls(int threads, int calls_per_thread, LogCall log_call) {
+    std::atomic<bool> go{false};
+    std::atomic<int> ready{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            ready++;
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < calls_per_thread; ++i) {
+                log_call(i);
+            }
+        });
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    auto start = steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return duration<double>(steady_clock::now() - start).count();
+}
+
+void benchmark_logger() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== Logger Benchmark: log calls per second ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    constexpr int kThreads = 8;
+    constexpr int kCallsPerThread = 100'000;
+    constexpr double kCalls = static_cast<double>(kThreads) * kCallsPerThread;
+    
+    std::cout << kThreads << " threads × " << kCallsPerThread
+              << " calls, output formatted then discarded\n\n";
+    
+    NullBuffer null_buffer;
+    std::ostream null_out(&null_buffer);
+    
+    // Same message construction on both sides
+    auto message = [](int i) {
+        return "Executed query #" + std::to_string(i) + ": SELECT * FROM actions WHERE action='get_user'";
+    };
+    
+    MutexLogger::set_output(null_out);
+    double mutex_s = time_log_calls(kThreads, kCallsPerThread, [&](int i) {
+        MutexLogger::log(Logger::INFO, message(i), "DatabaseService");
+    });
+    MutexLogger::set_output(std::cout);
+    
+    Logger::set_output(null_out);
+    
+    Logger::set_overflow(Logger::Overflow::BLOCK);
+    auto start = steady_clock::now();
+    double block_s = time_log_calls(kThreads, kCallsPerThread, [&](int i) {
+        Logger::log(Logger::INFO, message(i), "DatabaseService");
+    });
+    Logger::flush();
+    double block_written_s = duration<double>(steady_clock::now() - start).count();
+    
+    Logger::set_overflow(Logger::Overflow::DROP);
+    const uint64_t dropped_before = Logger::dropped();
+    double drop_s = time_log_calls(kThreads, kCallsPerThread, [&](int i) {
+        Logger::log(Logger::INFO, message(i), "DatabaseService");
+    });
+    Logger::flush();
+    const uint64_t dropped = Logger::dropped() - dropped_before;
+    
+    Logger::set_overflow(Logger::Overflow::BLOCK);
+    Logger::set_output(std::cout);
+    
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "  MutexLogger (previous):      " << std::setw(10) << kCalls / mutex_s << " calls/s\n";
+    std::cout << "  Logger, BLOCK on overflow:   " << std::setw(10) << kCalls / block_s << " calls/s ("
+              << kCalls / block_written_s << " lines/s written)\n";
+    std::cout << "  Logger, DROP on overflow:    " << std::setw(10) << kCalls / drop_s << " calls/s ("
+              << dropped << " dropped)\n";
+    std::cout << std::setprecision(1);
+    std::cout << "\n  Speed-up (BLOCK vs previous): " << mutex_s / block_s << "×\n";
+    std::cout << std::defaultfloat;
+    
+    std::cout << "\n✓ Callers no longer share a mutex or wait on the terminal\n";
+    std::cout << "  BLOCK is bounded by how fast the background thread formats;\n";
+    std::cout << "  DROP never waits, at the cost of losing lines under bursts\n";
+}
+
+// ============================================================================
+// SECTION 10: JSON Reader Benchmark
+// ============================================================================
+
+// The reader SimpleJson replaced, kept for comparison: a brace count over
+// the whole body, then a find() for the quoted key and a substr() per field
+class ScanJson {
+private:
+    std::string data_;
+    
+public:
+    explicit ScanJson(const std::string& json_str) : data_(json_str) {
+        if (data_.empty()) {
+            throw JsonParseException("Empty JSON string");
+        }
+        size_t start = data_.find_first_not_of(" \t\n\r");
+        size_t end = data_.find_last_not_of(" \t\n\r");
+        if (start == std::string::npos || data_[start] != '{' || data_[end] != '}') {
+            throw JsonParseException("Invalid JSON: must start with { and end with }");
+        }
+        int brace_count = 0;
+        for (char c : data_) {
+            if (c == '{') brace_count++;
+            if (c == '}') brace_count--;
+            if (brace_count < 0) {
+                throw JsonParseException("Invalid JSON: unmatched closing brace");
+            }
+        }
+        if (brace_count != 0) {
+            throw JsonParseException("Invalid JSON: unmatched opening brace");
+        }
+    }
+    
+    std::string get_field(const std::string& field_name) const {
+        std::string search = "\"" + field_name + "\"";
+        size_t pos = data_.find(search);
+        if (pos == std::string::npos) {
+            throw JsonParseException("Field not found: " + field_name);
+        }
+        size_t colon = data_.find(':', pos);
+        size_t value_start = data_.find_first_not_of(" \t\n\r", colon + 1);
+        size_t value_end = data_.find_first_of(",}", value_start);
+        if (colon == std::string::npos || value_start == std::string::npos ||
+            value_end == std::string::npos) {
+            throw JsonParseException("Cannot extract value for: " + field_name);
+        }
+        std::string value = data_.substr(value_start, value_end - value_start);
+        if (value.front() == '"' && value.back() == '"') {
+            value = value.substr(1, value.length() - 2);
+        }
+        return value;
+    }
+};
+
+// A REST body of roughly target_bytes: a few scalar fields up front, a
+// nested payload, and request_id/trace_id placed after the bulk
+std::string make_request_body(size_t target_bytes) {
+    std::string body = R"({"action": "create_order", "user_id": "123", "quantity": 2, "express": true,)";
+    body += R"( "items": [)";
+    for (int i = 0; body.size() + 160 < target_bytes; ++i) {
+        if (i > 0) {
+            body += ", ";
+        }
+        body += R"({"sku": "SKU-)" + std::to_string(10000 + i) + R"(", "price": )" +
+                std::to_string(i * 3 + 0.99) + R"(, "tags": ["a", "b"], "note": "gift wrap \"blue\""})";
+    }
+    body += R"(], "request_id": "req-7f3a9c", "trace_id": "4bf92f3577b34da6a3ce929d0e0e4736"})";
+    return body;
+}
+
+// ns per request: construct from the body, read four fields. The checksum
+// (total bytes of the fields read) is what the loop computes; printing it
+// keeps the work from being optimised away.
+struct RequestTiming {
+    double ns;
+    size_t checksum;
+};
+
+template<typename Json>
+RequestTiming ns_per_request(const std::string& body, int iterations) {
+    static const std::string fields[] = {"action", "user_id", "request_id", "trace_id"};
+    size_t checksum = 0;
+    auto start = steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        Json json(body);
+        for (const std::string& field : fields) {
+            checksum += json.get_field(field).size();
+        }
+    }
+    return {duration<double, std::nano>(steady_clock::now() - start).count() / iterations, checksum};
+}
+
+void benchmark_json_reader() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== JSON Reader Benchmark: ns per request ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    std::cout << "Per request: parse the body, read action, user_id, request_id, trace_id\n\n";
+    
+    // Same answers from both readers (scalar fields only: ScanJson cannot
+    // return nested values)
+    const std::string sample = make_request_body(1024);
+    SimpleJson tape(sample);
+    ScanJson scan(sample);
+    bool agree = true;
+    for (const char* field : {"action", "user_id", "quantity", "express", "request_id", "trace_id"}) {
+        agree = agree && tape.get_field(field) == scan.get_field(field);
+    }
+    std::cout << "  " << (agree ? "✓" : "✗") << " Both readers return the same field values ("
+              << tape.field_count() << " top-level fields)\n\n";
+    
+    std::cout << "  " << std::left << std::setw(10) << "body" << std::right << std::setw(16)
+              << "ScanJson (old)" << std::setw(18) << "SimpleJson (tape)" << std::setw(10) << "speed-up" << "\n";
+    size_t checksum = 0;
+    bool same_bytes = true;
+    for (size_t bytes : {1024, 2048, 4096}) {
+        const std::string body = make_request_body(bytes);
+        const int iterations = static_cast<int>(20'000'000 / bytes);
+        const RequestTiming old_run = ns_per_request<ScanJson>(body, iterations);
+        const RequestTiming new_run = ns_per_request<SimpleJson>(body, iterations);
+        same_bytes = same_bytes && old_run.checksum == new_run.checksum;
+        checksum += new_run.checksum;
+        std::cout << "  " << std::left << std::setw(10) << (std::to_string(body.size()) + " B")
+                  << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(13) << old_run.ns << " ns" << std::setw(15) << new_run.ns << " ns"
+                  << std::setprecision(1) << std::setw(9) << old_run.ns / new_run.ns << "×\n";
+    }
+    std::cout << std::defaultfloat;
+    std::cout << "\n  " << (same_bytes ? "✓" : "✗") << " Timed loops read the same field bytes "
+              << "(checksum " << checksum << ")\n";
+    
+    std::cout << "\n✓ One pass over the body; each further field is a hash lookup\n";
+    std::cout << "  ScanJson rescans the body for every field (O(fields × bytes))\n";
+}
+
+// ============================================================================
+// SECTION 11: Cache Benchmark
+// ============================================================================
+
+// Each lookup that misses is a "database" fill (put). Keys follow a Zipf
+// distribution (s = 1) over kKeys keys, so a few keys are very hot.
+void benchmark_cache() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== Cache Benchmark: sharded CLOCK cache ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    constexpr int kThreads = 8;
+    constexpr int kLookupsPerThread = 200'000;
+    constexpr int kKeys = 20'000;
+    constexpr size_t kBudget = size_t{2} << 20;  // Holds about half of the keys
+    
+    std::vector<std::string> keys;
+    std::vector<double> cdf;
+    double total = 0.0;
+    for (int k = 0; k < kKeys; ++k) {
+        keys.push_back("action:" + std::to_string(k));
+        total += 1.0 / (k + 1);
+        cdf.push_back(total);
+    }
+    for (double& c : cdf) {
+        c /= total;
+    }
+    const std::string row(64, 'r');
+    
+    std::cout << kThreads << " threads × " << kLookupsPerThread << " lookups, " << kKeys
+              << " Zipf keys, " << (kBudget >> 10) << " KiB budget; a miss fills the key\n\n";
+    
+    for (size_t shards : {1, 16}) {
+        ShardedCache cache(shards, kBudget, 60s);
+        auto start = steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&, t] {
+                std::mt19937 rng(t + 1);
+                std::uniform_real_distribution<double> uniform(0.0, 1.0);
+                for (int i = 0; i < kLookupsPerThread; ++i) {
+                    size_t k = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+                    const std::string& key = keys[std::min<size_t>(k, kKeys - 1)];
+                    if (!cache.get(key)) {
+                        cache.put(key, row);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double seconds = duration<double>(steady_clock::now() - start).count();
+        CacheStats stats = cache.stats();
+        
+        std::cout << "  " << std::setw(2) << shards << " shard(s): " << std::fixed << std::setprecision(0)
+                  << std::setw(10) << kThreads * kLookupsPerThread / seconds << " lookups/s, hit rate "
+                  << std::setprecision(1) << 100.0 * stats.hits / (stats.hits + stats.misses) << "%, "
+                  << stats.evictions << " evictions, " << stats.entries << " entries\n";
+        std::cout << std::defaultfloat;
+    }
+    
+    // TTL: an expired entry reads as a miss and is reclaimed by the sweep
+    ShardedCache short_lived(1, 4096, 50ms);
+    short_lived.put("session", "token");
+    bool fresh = short_lived.get("session").has_value();
+    std::this_thread::sleep_for(60ms);
+    bool stale = short_lived.get("session").has_value();
+    for (int i = 0; i < 64; ++i) {
+        short_lived.put("filler:" + std::to_string(i), "x");
+    }
+    std::cout << "\n  TTL 50ms: " << (fresh ? "hit" : "miss") << " at once, "
+              << (stale ? "hit" : "miss") << " after 60ms, "
+              << short_lived.stats().expirations << " reclaimed as expired\n";
+    
+    std::cout << "\n✓ Hits take the shard lock shared and only set a reference bit\n";
+    std::cout << "  Only misses reach DatabaseService, which fills the cache\n";
+}
+
+// ============================================================================
+// SECTION 12: Database Group Commit Benchmark
+// ============================================================================
+
+// A burst from 8 REST-like producers against a backend with a 100µs round
+// trip: one query per round trip versus up to 64
+void benchmark_database_batching() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== Database Benchmark: group commit ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    constexpr int kProducers = 8;
+    constexpr int kQueriesPerProducer = 1'000;
+    constexpr int kQueries = kProducers * kQueriesPerProducer;
+    
+    std::cout << kProducers << " producers × " << kQueriesPerProducer
+              << " queries, backend round trip 100µs + 2µs per query\n\n";
+    
+    // The per-query log lines are part of the cost but not of the output
+    NullBuffer null_buffer;
+    std::ostream null_out(&null_buffer);
+    Logger::set_output(null_out);
+    
+    for (size_t max_batch : {1, 64}) {
+        DatabaseConfig config;
+        config.max_batch = max_batch;
+        config.round_trip = microseconds(100);
+        config.per_query = microseconds(2);
+        DatabaseService db(config);
+        std::thread service(&DatabaseService::start, &db);
+        
+        std::atomic<int> answered{0};
+        auto start = steady_clock::now();
+        std::vector<std::thread> producers;
+        for (int p = 0; p < kProducers; ++p) {
+            producers.emplace_back([&, p] {
+                for (int i = 0; i < kQueriesPerProducer; ++i) {
+                    db.submit_query("SELECT * FROM orders WHERE id=" + std::to_string(p * kQueriesPerProducer + i),
+                                    [&answered](const std::string&) { answered++; });
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        while (answered.load() < kQueries) {
+            std::this_thread::sleep_for(1ms);
+        }
+        auto elapsed = steady_clock::now() - start;
+        db.stop();
+        service.join();
+        
+        DatabaseStats empty{};
+        std::cout << "  max_batch " << std::setw(2) << max_batch << ": "
+                  << MonitoringService::format_db_stats(empty, db.stats(), elapsed) << "\n";
+    }
+    
+    Logger::set_output(std::cout);
+    
+    std::cout << "\n✓ Producers never take a lock; one backend round trip serves a whole batch\n";
+}
+
 // ============================================================================
 // MAIN FUNCTION
 // ============================================================================
@@ -795,7 +2439,11 @@ int main() {
     std::cout << "  1. REST Service Exception (pthread_exit - graceful)\n";
     std::cout << "  2. CORE Service Exception (abort - terminates process)\n";
     std::cout << "  3. Best Practices Guide (no execution)\n";
-    std::cout << "\nEnter choice (1-3): ";
+    std::cout << "  4. Logger Benchmark (8 threads, no console output)\n";
+    std::cout << "  5. JSON Reader Benchmark (1-4 KB request bodies)\n";
+    std::cout << "  6. Cache Benchmark (8 threads, Zipf keys)\n";
+    std::cout << "  7. Database Group Commit Benchmark\n";
+    std::cout << "\nEnter choice (1-7): ";
     
     int choice;
     std::cin >> choice;
@@ -816,6 +2464,22 @@ int main() {
             demonstrate_best_practices();
             break;
             
+        case 4:
+            benchmark_logger();
+            break;
+            
+        case 5:
+            benchmark_json_reader();
+            break;
+            
+        case 6:
+            benchmark_cache();
+            break;
+            
+        case 7:
+            benchmark_database_batching();
+            break;
+            
         default:
             std::cout << "\nInvalid choice. Running REST demonstration by default.\n";
             demonstrate_rest_service_exception();
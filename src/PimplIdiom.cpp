@@ -23,6 +23,7 @@
 #include <vector>
 #include <chrono>
 #include <iomanip>
+#include <cstddef>
 
 // ===================================================================
 // SECTION 1: WHAT IS THE PIMPL IDIOM?
@@ -0,0 +1,367 @@
+// PoolBench.h
+// Common benchmark harness for every thread pool in the examples
+// (ThreadPoolExamples, FuturePromiseAsync, StopTokenExample)
+//
+// Each pool is run through the same four workloads:
+// - empty:      one producer, tasks that do nothing (pure scheduling overhead)
+// - skewed:     90% ~2µs tasks, 10% ~200µs tasks (load balancing)
+// - recursive:  a binary tree of tasks, each spawning its children from
+//               inside a worker (nested submission)
+// - storm:      many producers start together and submit as fast as they
+//               can (queue contention)
+//
+// Reported per pool and workload:
+// - throughput (tasks/s)
+// - submit-to-start latency p50 / p99 / p999
+// - CPU utilisation: process CPU time over wall time × hardware threads
+//   (spinning workers show up here)
+// - caller runs: tasks a pool ran on the submitting thread because its
+//   queue was full. Their "latency" is not queueing latency.
+//
+// Results print as a table and are written as JSON.
+//
+// Requires C++20 (std::atomic::wait).
+
+#ifndef POOL_BENCH_H
+#define POOL_BENCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "InplaceTask.h"
+
+struct PoolBenchConfig {
+    size_t threads = std::max(2u, std::thread::hardware_concurrency());
+    size_t empty_tasks = 200'000;
+    size_t skewed_tasks = 20'000;
+    size_t recursive_depth = 16;      // 2^(depth+1) - 1 tasks
+    size_t storm_producers = 8;
+    size_t storm_tasks = 200'000;     // Split across the producers
+    size_t queue_capacity = 16384;    // Per queue, for pools with bounded queues
+
+    // Small sizes for the walkthrough in the examples binary
+    static PoolBenchConfig quick() {
+        PoolBenchConfig config;
+        config.empty_tasks = 20'000;
+        config.skewed_tasks = 2'000;
+        config.recursive_depth = 12;
+        config.storm_producers = 4;
+        config.storm_tasks = 20'000;
+        config.queue_capacity = 2048;
+        return config;
+    }
+};
+
+struct WorkloadResult {
+    std::string pool;
+    std::string workload;
+    size_t tasks;
+    double wall_ms;
+    double tasks_per_sec;
+    double p50_us;
+    double p99_us;
+    double p999_us;
+    double cpu_utilisation;  // 0..1 of all hardware threads
+    size_t caller_runs;      // Ran on the submitter (full queue); see run_pool_workloads
+};
+
+namespace pool_bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline double process_cpu_seconds() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#else
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+// Busy-waits so that task cost does not depend on timer slack
+inline void spin_for(std::chrono::nanoseconds d) {
+    auto until = Clock::now() + d;
+    while (Clock::now() < until) {
+    }
+}
+
+// The waiting thread blocks on a futex instead of spinning, so it does not
+// count towards CPU utilisation. Only the last count_down() notifies.
+class CompletionLatch {
+public:
+    explicit CompletionLatch(size_t target) : target_(target) {}
+
+    void count_down() {
+        if (done_.fetch_add(1, std::memory_order_acq_rel) + 1 == target_) {
+            done_.notify_all();
+        }
+    }
+
+    void wait() {
+        size_t seen = done_.load(std::memory_order_acquire);
+        while (seen < target_) {
+            done_.wait(seen, std::memory_order_acquire);
+            seen = done_.load(std::memory_order_acquire);
+        }
+    }
+
+private:
+    std::atomic<size_t> done_{0};
+    size_t target_;
+};
+
+// One slot per task, written once by the task that owns it
+class LatencyRecorder {
+public:
+    explicit LatencyRecorder(size_t tasks) : ns_(tasks) {}
+
+    void record(size_t id, Clock::time_point submitted) {
+        ns_[id] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - submitted).count();
+    }
+
+    // q in [0, 1]; microseconds
+    double percentile(double q) {
+        if (!sorted_) {
+            std::sort(ns_.begin(), ns_.end());
+            sorted_ = true;
+        }
+        size_t index = std::min(ns_.size() - 1, static_cast<size_t>(q * ns_.size()));
+        return ns_[index] / 1000.0;
+    }
+
+private:
+    std::vector<int64_t> ns_;
+    bool sorted_ = false;
+};
+
+// Everything a workload needs to time one run
+struct Run {
+    LatencyRecorder latency;
+    CompletionLatch latch;
+    size_t tasks;
+
+    explicit Run(size_t n) : latency(n), latch(n), tasks(n) {}
+};
+
+// body() submits the work; the clock stops when the last task counts down
+template<typename Body>
+WorkloadResult measure(const std::string& pool, const std::string& workload,
+                       Run& run, Body body) {
+    const size_t tasks = run.tasks;
+    const double cpu_before = process_cpu_seconds();
+    const auto start = Clock::now();
+
+    body();
+    run.latch.wait();
+
+    const double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    const double cpu = process_cpu_seconds() - cpu_before;
+    const double hw = std::max(1u, std::thread::hardware_concurrency());
+
+    return {pool, workload, tasks, wall * 1000.0, tasks / wall,
+            run.latency.percentile(0.50), run.latency.percentile(0.99),
+            run.latency.percentile(0.999), cpu / (wall * hw), 0};
+}
+
+// Default caller_runs hook: the pool never runs tasks on the submitter
+struct NoCallerRuns {
+    template<typename Pool>
+    size_t operator()(const Pool&) const { return 0; }
+};
+
+}  // namespace pool_bench
+
+// Runs all four workloads on a fresh pool each. make_pool() returns a
+// std::unique_ptr to the pool; submit(pool, InplaceTask) hands it one task.
+// The pool is built before and destroyed after the timed region.
+// caller_runs(pool) is read once each workload has finished, while its
+// pool is still alive, and fills WorkloadResult::caller_runs.
+template<typename MakePool, typename Submit, typename CallerRuns = pool_bench::NoCallerRuns>
+std::vector<WorkloadResult> run_pool_workloads(const std::string& name, MakePool make_pool,
+                                               Submit submit, const PoolBenchConfig& config,
+                                               CallerRuns caller_runs = {}) {
+    using pool_bench::Clock;
+    using pool_bench::Run;
+    std::vector<WorkloadResult> results;
+
+    {
+        auto pool = make_pool();
+        Run run(config.empty_tasks);
+        results.push_back(pool_bench::measure(name, "empty", run, [&]() {
+            for (size_t id = 0; id < run.tasks; ++id) {
+                auto submitted = Clock::now();
+                submit(*pool, InplaceTask([&run, id, submitted]() {
+                    run.latency.record(id, submitted);
+                    run.latch.count_down();
+                }));
+            }
+        }));
+        results.back().caller_runs = caller_runs(*pool);
+    }
+
+    {
+        auto pool = make_pool();
+        Run run(config.skewed_tasks);
+        results.push_back(pool_bench::measure(name, "skewed", run, [&]() {
+            for (size_t id = 0; id < run.tasks; ++id) {
+                auto submitted = Clock::now();
+                // Multiplicative hash spreads the long tasks out
+                bool heavy = (id * 2654435761u) % 10 == 0;
+                submit(*pool, InplaceTask([&run, id, submitted, heavy]() {
+                    run.latency.record(id, submitted);
+                    pool_bench::spin_for(heavy ? std::chrono::microseconds(200)
+                                               : std::chrono::microseconds(2));
+                    run.latch.count_down();
+                }));
+            }
+        }));
+        results.back().caller_runs = caller_runs(*pool);
+    }
+
+    {
+        auto pool = make_pool();
+        using Pool = typename decltype(pool)::element_type;
+        const size_t tasks = (size_t{2} << config.recursive_depth) - 1;
+
+        // Node ids are heap-numbered (children 2i+1, 2i+2), so every task
+        // knows its latency slot without a shared counter
+        struct Tree {
+            Pool& pool;
+            Submit& submit;
+            Run& run;
+            size_t max_depth;
+
+            void spawn(size_t id, size_t depth) {
+                auto submitted = Clock::now();
+                submit(pool, InplaceTask([this, id, depth, submitted]() {
+                    run.latency.record(id, submitted);
+                    if (depth < max_depth) {
+                        spawn(2 * id + 1, depth + 1);
+                        spawn(2 * id + 2, depth + 1);
+                    }
+                    run.latch.count_down();
+                }));
+            }
+        };
+
+        Run run(tasks);
+        Tree tree{*pool, submit, run, config.recursive_depth};
+        results.push_back(pool_bench::measure(name, "recursive", run, [&]() {
+            tree.spawn(0, 0);
+        }));
+        results.back().caller_runs = caller_runs(*pool);
+    }
+
+    {
+        auto pool = make_pool();
+        const size_t producers = std::max<size_t>(1, config.storm_producers);
+        const size_t per_producer = config.storm_tasks / producers;
+        Run run(per_producer * producers);
+
+        results.push_back(pool_bench::measure(name, "storm", run, [&]() {
+            std::atomic<bool> go{false};
+            std::vector<std::thread> threads;
+            for (size_t p = 0; p < producers; ++p) {
+                threads.emplace_back([&, p]() {
+                    while (!go.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    for (size_t i = 0; i < per_producer; ++i) {
+                        const size_t id = p * per_producer + i;
+                        auto submitted = Clock::now();
+                        submit(*pool, InplaceTask([&run, id, submitted]() {
+                            run.latency.record(id, submitted);
+                            run.latch.count_down();
+                        }));
+                    }
+                });
+            }
+            go.store(true, std::memory_order_release);
+            for (auto& t : threads) {
+                t.join();
+            }
+        }));
+        results.back().caller_runs = caller_runs(*pool);
+    }
+
+    return results;
+}
+
+// Grouped by workload, in the order the workloads first appear
+inline void print_pool_bench_table(const std::vector<WorkloadResult>& results) {
+    std::cout << "  " << std::left << std::setw(24) << "pool" << std::setw(11) << "workload"
+              << std::right << std::setw(12) << "tasks/s" << std::setw(10) << "p50 µs"
+              << std::setw(10) << "p99 µs" << std::setw(11) << "p999 µs"
+              << std::setw(8) << "CPU %" << std::setw(9) << "caller" << "\n";
+
+    std::vector<std::string> workloads;
+    for (const auto& r : results) {
+        if (std::find(workloads.begin(), workloads.end(), r.workload) == workloads.end()) {
+            workloads.push_back(r.workload);
+        }
+    }
+
+    for (const auto& workload : workloads) {
+        std::cout << "\n";
+        for (const auto& r : results) {
+            if (r.workload != workload) {
+                continue;
+            }
+            std::cout << "  " << std::left << std::setw(24) << r.pool << std::setw(11) << r.workload
+                      << std::right << std::fixed << std::setprecision(0)
+                      << std::setw(12) << r.tasks_per_sec << std::setprecision(1)
+                      << std::setw(10) << r.p50_us << std::setw(10) << r.p99_us
+                      << std::setw(11) << r.p999_us << std::setw(8) << r.cpu_utilisation * 100.0
+                      << std::setw(9) << r.caller_runs << "\n";
+        }
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+inline void write_pool_bench_json(std::ostream& out, const std::vector<WorkloadResult>& results,
+                                  const PoolBenchConfig& config) {
+    out << "{\n";
+    out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"worker_threads\": " << config.threads << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        // Pool and workload names are fixed identifiers: no escaping needed
+        out << "    {\"pool\": \"" << r.pool << "\", \"workload\": \"" << r.workload
+            << "\", \"tasks\": " << r.tasks
+            << ", \"wall_ms\": " << r.wall_ms
+            << ", \"throughput_tasks_per_sec\": " << r.tasks_per_sec
+            << ", \"latency_us\": {\"p50\": " << r.p50_us << ", \"p99\": " << r.p99_us
+            << ", \"p999\": " << r.p999_us << "}"
+            << ", \"cpu_utilisation\": " << r.cpu_utilisation
+            << ", \"caller_runs\": " << r.caller_runs << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+// Defined in FuturePromiseAsync.cpp and StopTokenExample.cpp when they are
+// compiled into the ThreadPoolBench target (THREAD_POOL_BENCH)
+std::vector<WorkloadResult> bench_simple_thread_pool(const PoolBenchConfig& config);
+std::vector<WorkloadResult> bench_stop_token_thread_pool(const PoolBenchConfig& config);
+
+#endif // POOL_BENCH_H
@@ -35,6 +35,12 @@
 #include <iomanip>
 #include <functional>
 
+#include "InplaceTask.h"
+
+#ifdef THREAD_POOL_BENCH
+#include "PoolBench.h"
+#endif
+
 using namespace std::chrono_literals;
 
 // ============================================================================
@@ -350,29 +356,32 @@ namespace thread_pool_example {
 class ThreadPool {
 private:
     std::vector<std::jthread> workers_;
-    std::queue<std::function<void()>> tasks_;
+    TaskQueue tasks_;  // Move-only InplaceTasks, no per-task heap allocation
     std::mutex mutex_;
     std::condition_variable_any cv_;
+    bool verbose_;
     
 public:
-    explicit ThreadPool(size_t num_threads) {
+    // verbose = false silences the per-task trace (ThreadPoolBench)
+    explicit ThreadPool(size_t num_threads, bool verbose = true) : verbose_(verbose) {
         for (size_t i = 0; i < num_threads; ++i) {
             workers_.emplace_back([this, i](std::stop_token stoken) {
-                std::cout << "  [Worker " << i << "] Started\n";
+                if (verbose_) std::cout << "  [Worker " << i << "] Started\n";
                 
                 while (!stoken.stop_requested()) {
-                    std::function<void()> task;
+                    InplaceTask task;
                     
                     {
                         std::unique_lock<std::mutex> lock(mutex_);
                         
-                        // Wait for task or stop signal
-                        bool stop = cv_.wait(lock, stoken, [this] { 
+                        // Wait for task or stop signal. Returns the predicate:
+                        // false means the wait ended because of the stop request
+                        bool has_task = cv_.wait(lock, stoken, [this] { 
                             return !tasks_.empty(); 
                         });
                         
-                        if (stop) {
-                            std::cout << "  [Worker " << i << "] Stop requested\n";
+                        if (!has_task) {
+                            if (verbose_) std::cout << "  [Worker " << i << "] Stop requested\n";
                             break;
                         }
                         
@@ -383,12 +392,12 @@ public:
                     }
                     
                     if (task) {
-                        std::cout << "  [Worker " << i << "] Executing task\n";
+                        if (verbose_) std::cout << "  [Worker " << i << "] Executing task\n";
                         task();
                     }
                 }
                 
-                std::cout << "  [Worker " << i << "] Stopped\n";
+                if (verbose_) std::cout << "  [Worker " << i << "] Stopped\n";
             });
         }
     }
@@ -403,7 +412,7 @@ public:
     }
     
     void stop() {
-        std::cout << "  [ThreadPool] Requesting stop for all workers...\n";
+        if (verbose_) std::cout << "  [ThreadPool] Requesting stop for all workers...\n";
         for (auto& worker : workers_) {
             worker.request_stop();
         }
@@ -689,6 +698,21 @@ void show_summary() {
 // MAIN FUNCTION
 // ============================================================================
 
+#ifdef THREAD_POOL_BENCH
+
+// ThreadPoolBench links this file for thread_pool_example::ThreadPool; its
+// main() is in ThreadPoolExamples.cpp
+std::vector<WorkloadResult> bench_stop_token_thread_pool(const PoolBenchConfig& config) {
+    using thread_pool_example::ThreadPool;
+    return run_pool_workloads(
+        "StopToken ThreadPool",
+        [&config]() { return std::make_unique<ThreadPool>(config.threads, false); },
+        [](ThreadPool& pool, InplaceTask task) { pool.enqueue(std::move(task)); },
+        config);
+}
+
+#else
+
 int main() {
     std::cout << "\n";
     std::cout << "╔════════════════════════════════════════════════════════════════╗\n";
@@ -728,3 +752,5 @@ int main() {
     
     return 0;
 }
+
+#endif  // THREAD_POOL_BENCH
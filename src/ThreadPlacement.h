@@ -0,0 +1,284 @@
+// ThreadPlacement.h
+// CPU topology, worker pinning and per-worker statistics for the thread
+// pool examples (ThreadPoolExamples)
+//
+// WHY PIN WORKERS?
+// - An unpinned worker can be migrated by the scheduler at any time. After
+//   a migration its L1/L2 contents are gone.
+// - On a multi-socket machine a migration can also move it away from the
+//   NUMA node that holds the memory it first touched. Every later access to
+//   that memory is then remote.
+// - Work stealing adds more cross-core traffic: a task stolen from another
+//   socket drags its data over the interconnect
+//
+// WHAT'S HERE:
+// - CpuTopology:      CPUs this process may run on, with socket, core and
+//                     NUMA node ids (Linux sysfs; one socket elsewhere)
+// - ThreadPlacement:  NONE / COMPACT / SCATTER / explicit core sets,
+//                     resolved into one CPU set per worker
+// - pin_current_thread()
+// - WorkerCounters:   tasks run, tasks stolen, idle time and queue depth
+//                     high-water mark, written only by the owning worker
+// - WorkerStats:      snapshot of one worker, returned by worker_stats()
+//
+// Requires C++17.
+
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// ============================================================================
+// Topology
+// ============================================================================
+
+struct CpuInfo {
+    int cpu;
+    int socket;  // physical_package_id
+    int core;    // core_id within the socket (SMT siblings share it)
+    int node;    // NUMA node
+};
+
+class CpuTopology {
+public:
+    // Discovered once; the affinity mask of the process at first use decides
+    // which CPUs are listed (so taskset/cgroup limits are respected)
+    static const CpuTopology& instance() {
+        static const CpuTopology topology;
+        return topology;
+    }
+
+    const std::vector<CpuInfo>& cpus() const { return cpus_; }
+    std::size_t socket_count() const { return socket_count_; }
+
+    int socket_of(int cpu) const {
+        for (const CpuInfo& info : cpus_) {
+            if (info.cpu == cpu) {
+                return info.socket;
+            }
+        }
+        return -1;
+    }
+
+private:
+    std::vector<CpuInfo> cpus_;
+    std::size_t socket_count_ = 1;
+
+    CpuTopology() {
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) {
+                    cpus_.push_back({cpu, read_id(cpu, "topology/physical_package_id"),
+                                     read_id(cpu, "topology/core_id"), node_of(cpu)});
+                }
+            }
+        }
+#endif
+        if (cpus_.empty()) {
+            unsigned n = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned cpu = 0; cpu < n; ++cpu) {
+                int id = static_cast<int>(cpu);
+                cpus_.push_back({id, 0, id, 0});
+            }
+        }
+
+        std::vector<int> sockets;
+        for (const CpuInfo& info : cpus_) {
+            if (std::find(sockets.begin(), sockets.end(), info.socket) == sockets.end()) {
+                sockets.push_back(info.socket);
+            }
+        }
+        socket_count_ = sockets.size();
+    }
+
+    static std::string cpu_dir(int cpu) {
+        return "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/";
+    }
+
+    // Missing sysfs entries (containers, non-NUMA kernels) read as 0
+    static int read_id(int cpu, const char* file) {
+        std::ifstream in(cpu_dir(cpu) + file);
+        int id = 0;
+        if (!(in >> id) || id < 0) {
+            return 0;
+        }
+        return id;
+    }
+
+    static int node_of(int cpu) {
+        // cpuN/nodeM is a symlink that exists only for the CPU's own node
+        for (int node = 0; node < 64; ++node) {
+            std::ifstream probe(cpu_dir(cpu) + "node" + std::to_string(node) + "/cpumap");
+            if (probe) {
+                return node;
+            }
+        }
+        return 0;
+    }
+};
+
+// ============================================================================
+// Placement
+// ============================================================================
+
+enum class PlacementPolicy {
+    NONE,       // Leave workers to the scheduler
+    COMPACT,    // Fill one socket core by core before using the next
+    SCATTER,    // Round-robin across sockets (spreads memory bandwidth)
+    CORE_SETS   // Explicit: worker i runs on core_sets[i % core_sets.size()]
+};
+
+struct ThreadPlacement {
+    PlacementPolicy policy = PlacementPolicy::NONE;
+    std::vector<std::vector<int>> core_sets;
+
+    static ThreadPlacement none() { return {}; }
+    static ThreadPlacement compact() { return {PlacementPolicy::COMPACT, {}}; }
+    static ThreadPlacement scatter() { return {PlacementPolicy::SCATTER, {}}; }
+    static ThreadPlacement cores(std::vector<std::vector<int>> sets) {
+        return {PlacementPolicy::CORE_SETS, std::move(sets)};
+    }
+
+    bool pins() const { return policy != PlacementPolicy::NONE; }
+
+    // CPUs worker `index` should run on; empty means unpinned. Workers
+    // beyond the CPU count wrap around and share CPUs.
+    std::vector<int> cpus_for(std::size_t index) const {
+        if (policy == PlacementPolicy::CORE_SETS) {
+            if (core_sets.empty()) {
+                return {};
+            }
+            return core_sets[index % core_sets.size()];
+        }
+        if (policy == PlacementPolicy::NONE) {
+            return {};
+        }
+
+        std::vector<CpuInfo> order = CpuTopology::instance().cpus();
+        std::sort(order.begin(), order.end(), [](const CpuInfo& a, const CpuInfo& b) {
+            if (a.socket != b.socket) return a.socket < b.socket;
+            if (a.core != b.core) return a.core < b.core;
+            return a.cpu < b.cpu;
+        });
+
+        if (policy == PlacementPolicy::SCATTER) {
+            // Interleave the per-socket lists: s0[0], s1[0], s0[1], s1[1], ...
+            std::vector<std::vector<CpuInfo>> per_socket;
+            for (const CpuInfo& info : order) {
+                if (per_socket.empty() || per_socket.back().front().socket != info.socket) {
+                    per_socket.emplace_back();
+                }
+                per_socket.back().push_back(info);
+            }
+            std::vector<CpuInfo> interleaved;
+            for (std::size_t i = 0; interleaved.size() < order.size(); ++i) {
+                for (const auto& socket : per_socket) {
+                    if (i < socket.size()) {
+                        interleaved.push_back(socket[i]);
+                    }
+                }
+            }
+            order.swap(interleaved);
+        }
+
+        return {order[index % order.size()].cpu};
+    }
+
+    // Socket of a CPU set (its first CPU); -1 for an unpinned worker
+    static int socket_of(const std::vector<int>& cpus) {
+        return cpus.empty() ? -1 : CpuTopology::instance().socket_of(cpus.front());
+    }
+};
+
+// Pins the calling thread. Returns false if the set is empty, the platform
+// has no affinity API, or the kernel refused (e.g. CPU outside the cgroup).
+inline bool pin_current_thread(const std::vector<int>& cpus) {
+#ifdef __linux__
+    if (cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+// ============================================================================
+// Per-worker statistics
+// ============================================================================
+
+// One cache line per worker. Only the owning worker writes, so updates are
+// a relaxed load + store rather than a locked read-modify-write. Readers
+// (worker_stats()) see slightly stale values.
+struct alignas(64) WorkerCounters {
+    std::atomic<uint64_t> tasks_run{0};
+    std::atomic<uint64_t> tasks_stolen{0};
+    std::atomic<uint64_t> idle_ns{0};
+    std::atomic<uint64_t> queue_high_water{0};
+    std::atomic<bool> pinned{false};
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    void ran_task() { bump(tasks_run); }
+    void stole_task() { bump(tasks_stolen); }
+
+    void idle_for(std::chrono::steady_clock::duration d) {
+        bump(idle_ns, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()));
+    }
+
+    void saw_queue_depth(std::size_t depth) {
+        if (depth > queue_high_water.load(std::memory_order_relaxed)) {
+            queue_high_water.store(depth, std::memory_order_relaxed);
+        }
+    }
+};
+
+struct WorkerStats {
+    std::size_t worker;
+    std::vector<int> cpus;     // Empty if unpinned
+    int socket;                // -1 if unpinned
+    bool pinned;               // pin_current_thread() succeeded
+    uint64_t tasks_run;
+    uint64_t tasks_stolen;
+    double idle_ms;
+    uint64_t queue_high_water;
+};
+
+inline WorkerStats snapshot(std::size_t worker, const std::vector<int>& cpus,
+                            const WorkerCounters& c) {
+    return {worker, cpus, ThreadPlacement::socket_of(cpus),
+            c.pinned.load(std::memory_order_relaxed),
+            c.tasks_run.load(std::memory_order_relaxed),
+            c.tasks_stolen.load(std::memory_order_relaxed),
+            c.idle_ns.load(std::memory_order_relaxed) / 1e6,
+            c.queue_high_water.load(std::memory_order_relaxed)};
+}
+
+#endif // THREAD_PLACEMENT_H
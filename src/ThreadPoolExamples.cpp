@@ -17,6 +17,22 @@
 #include <deque>
 #include <optional>
 #include <iomanip>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <iterator>
+#include <exception>
+#include <string>
+#include <utility>
+#include <fstream>
+
+#include "InplaceTask.h"
+#include "ThreadPlacement.h"
+#include "PoolBench.h"
 
 using namespace std::chrono_literals;
 
@@ -24,77 +40,256 @@ using namespace std::chrono_literals;
 // SECTION 1: Basic Thread Pool (Simplest Implementation)
 // ============================================================================
 
-class BasicThreadPool {
+// What submit() does when a bounded queue is full
+enum class OverflowPolicy {
+    BLOCK,        // Wait for a free slot (producer slows to worker speed)
+    REJECT,       // Refuse the task; submit reports failure
+    DROP_OLDEST,  // Evict the longest-waiting task to make room
+    CALLER_RUNS   // Run the task on the submitting thread (natural throttle)
+};
+
+struct BackpressureStats {
+    size_t submitted = 0;    // Accepted into the queue
+    size_t rejected = 0;     // Refused (REJECT policy or try_submit)
+    size_t blocked = 0;      // Submissions that had to wait for a slot
+    size_t dropped = 0;      // Evicted by DROP_OLDEST
+    size_t caller_runs = 0;  // Executed inline by CALLER_RUNS
+};
+
+// Task queue shared by BasicThreadPool and ThreadPoolWithFutures.
+// capacity == 0 means unbounded (the original behaviour).
+class BoundedTaskQueue {
 private:
-    std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex queue_mutex_;
-    std::condition_variable condition_;
-    bool stop_;
+    TaskQueue tasks_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    size_t capacity_;
+    OverflowPolicy policy_;
+    bool stop_ = false;
+    BackpressureStats stats_;
+    
+    bool full() const { return capacity_ != 0 && tasks_.size() >= capacity_; }
     
 public:
-    explicit BasicThreadPool(size_t num_threads) : stop_(false) {
-        std::cout << "  Creating thread pool with " << num_threads << " workers\n";
-        
-        for (size_t i = 0; i < num_threads; ++i) {
-            workers_.emplace_back([this, i]() {
-                std::cout << "    Worker " << i << " started (thread " 
-                          << std::this_thread::get_id() << ")\n";
-                
-                while (true) {
-                    std::function<void()> task;
-                    
-                    {
-                        std::unique_lock<std::mutex> lock(queue_mutex_);
-                        
-                        // Wait until there's work or we're stopping
-                        condition_.wait(lock, [this]() {
-                            return stop_ || !tasks_.empty();
-                        });
-                        
-                        if (stop_ && tasks_.empty()) {
-                            return;
+    explicit BoundedTaskQueue(size_t capacity = 0,
+                              OverflowPolicy policy = OverflowPolicy::BLOCK)
+        : capacity_(capacity), policy_(policy) {}
+    
+    OverflowPolicy policy() const { return policy_; }
+    
+    // Returns false only if the task was rejected. With CALLER_RUNS the
+    // task has already executed on this thread when push() returns true.
+    bool push(InplaceTask& task) {
+        return push(task, policy_);
+    }
+    
+    bool push(InplaceTask& task, OverflowPolicy policy) {
+        InplaceTask evicted;  // Destroyed outside the lock
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            
+            if (stop_) {
+                throw std::runtime_error("Cannot submit task to stopped thread pool");
+            }
+            
+            if (full()) {
+                switch (policy) {
+                    case OverflowPolicy::BLOCK:
+                        ++stats_.blocked;
+                        not_full_.wait(lock, [this]() { return stop_ || !full(); });
+                        if (stop_) {
+                            throw std::runtime_error("Thread pool stopped while waiting for queue space");
                         }
+                        break;
                         
-                        task = std::move(tasks_.front());
+                    case OverflowPolicy::REJECT:
+                        ++stats_.rejected;
+                        return false;
+                        
+                    case OverflowPolicy::DROP_OLDEST:
+                        ++stats_.dropped;
+                        evicted = std::move(tasks_.front());
                         tasks_.pop();
-                    }
-                    
-                    task();  // Execute the task
+                        break;
+                        
+                    case OverflowPolicy::CALLER_RUNS:
+                        ++stats_.caller_runs;
+                        lock.unlock();
+                        task();
+                        return true;
                 }
-            });
+            }
+            
+            tasks_.push(std::move(task));
+            ++stats_.submitted;
         }
+        
+        not_empty_.notify_one();
+        return true;
     }
     
-    // Submit a task (no return value)
-    void submit(std::function<void()> task) {
+    // Blocks until a task is available; empty result means shut down and
+    // drained. depth_seen receives the queue length just before the pop.
+    std::optional<InplaceTask> pop(size_t* depth_seen = nullptr) {
+        std::optional<InplaceTask> task;
         {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
+            std::unique_lock<std::mutex> lock(mutex_);
             
-            if (stop_) {
-                throw std::runtime_error("Cannot submit task to stopped thread pool");
+            // Wait until there's work or we're stopping
+            not_empty_.wait(lock, [this]() {
+                return stop_ || !tasks_.empty();
+            });
+            
+            if (stop_ && tasks_.empty()) {
+                return std::nullopt;
             }
             
-            tasks_.push(std::move(task));
+            if (depth_seen) {
+                *depth_seen = tasks_.size();
+            }
+            task.emplace(std::move(tasks_.front()));
+            tasks_.pop();
         }
-        condition_.notify_one();
+        
+        if (capacity_ != 0) {
+            not_full_.notify_one();
+        }
+        return task;
     }
     
-    ~BasicThreadPool() {
+    // Non-blocking pop for threads that help while they wait
+    std::optional<InplaceTask> try_pop() {
+        std::optional<InplaceTask> task;
         {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tasks_.empty()) {
+                return std::nullopt;
+            }
+            task.emplace(std::move(tasks_.front()));
+            tasks_.pop();
+        }
+        
+        if (capacity_ != 0) {
+            not_full_.notify_one();
+        }
+        return task;
+    }
+    
+    // Runs one queued task on the calling thread; false if there was none
+    bool run_one() {
+        if (auto task = try_pop()) {
+            (*task)();
+            return true;
+        }
+        return false;
+    }
+    
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
             stop_ = true;
         }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+    
+    BackpressureStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+};
+
+class BasicThreadPool {
+private:
+    struct Worker {
+        std::thread thread;
+        std::vector<int> cpus;  // Empty = unpinned
+        WorkerCounters counters;
+    };
+    
+    std::vector<std::unique_ptr<Worker>> workers_;
+    BoundedTaskQueue tasks_;
+    bool verbose_;
+    
+    void worker_loop(Worker& self) {
+        auto waiting_since = std::chrono::steady_clock::now();
+        size_t depth = 0;
+        
+        while (auto task = tasks_.pop(&depth)) {
+            self.counters.idle_for(std::chrono::steady_clock::now() - waiting_since);
+            self.counters.saw_queue_depth(depth);
+            
+            (*task)();  // Execute the task
+            
+            self.counters.ran_task();
+            waiting_since = std::chrono::steady_clock::now();
+        }
+    }
+    
+public:
+    explicit BasicThreadPool(size_t num_threads, size_t queue_capacity = 0,
+                             OverflowPolicy policy = OverflowPolicy::BLOCK,
+                             const ThreadPlacement& placement = {}, bool verbose = true)
+        : tasks_(queue_capacity, policy), verbose_(verbose) {
+        if (verbose_) {
+            std::cout << "  Creating thread pool with " << num_threads << " workers\n";
+        }
         
-        condition_.notify_all();
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+            workers_.back()->cpus = placement.cpus_for(i);
+        }
         
-        for (std::thread& worker : workers_) {
-            if (worker.joinable()) {
-                worker.join();
+        for (size_t i = 0; i < num_threads; ++i) {
+            Worker& worker = *workers_[i];
+            worker.thread = std::thread([this, i, &worker]() {
+                if (!worker.cpus.empty()) {
+                    worker.counters.pinned.store(pin_current_thread(worker.cpus));
+                }
+                if (verbose_) {
+                    std::cout << "    Worker " << i << " started (thread " 
+                              << std::this_thread::get_id() << ")\n";
+                }
+                worker_loop(worker);
+            });
+        }
+    }
+    
+    // Submit a task (no return value). Applies the overflow policy when the
+    // queue is full; returns false only if the task was rejected.
+    bool submit(InplaceTask task) {
+        return tasks_.push(task);
+    }
+    
+    // Never blocks, drops or runs inline: false if the queue is full
+    bool try_submit(InplaceTask task) {
+        return tasks_.push(task, OverflowPolicy::REJECT);
+    }
+    
+    BackpressureStats stats() const { return tasks_.stats(); }
+    
+    // tasks_stolen is always 0: there is only the shared queue
+    std::vector<WorkerStats> worker_stats() const {
+        std::vector<WorkerStats> result;
+        for (size_t i = 0; i < workers_.size(); ++i) {
+            result.push_back(snapshot(i, workers_[i]->cpus, workers_[i]->counters));
+        }
+        return result;
+    }
+    
+    ~BasicThreadPool() {
+        tasks_.shutdown();
+        
+        for (auto& worker : workers_) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
             }
         }
         
-        std::cout << "  Thread pool destroyed\n";
+        if (verbose_) {
+            std::cout << "  Thread pool destroyed\n";
+        }
     }
 };
 
@@ -128,76 +323,116 @@ void demonstrate_basic_thread_pool() {
 // SECTION 2: Thread Pool with Futures (Return Values)
 // ============================================================================
 
+// std::future wrapper returned by ThreadPoolWithFutures. wait()/get() run
+// other queued tasks while the result is not ready, so a task can wait on
+// children it submitted to the same pool without tying up its worker -
+// with a plain std::future, recursion deeper than the pool size deadlocks.
+template<typename T>
+class PoolFuture {
+private:
+    std::future<T> future_;
+    BoundedTaskQueue* queue_ = nullptr;
+    
+public:
+    PoolFuture() = default;
+    PoolFuture(std::future<T> future, BoundedTaskQueue& queue)
+        : future_(std::move(future)), queue_(&queue) {}
+    
+    bool valid() const noexcept { return future_.valid(); }
+    
+    void wait() const {
+        // Nothing queued means the awaited task is already running on
+        // another thread: wait on it with a growing timeout, re-checking
+        // the queue in between in case that task forks more work
+        std::chrono::microseconds backoff{0};
+        while (future_.wait_for(backoff) != std::future_status::ready) {
+            if (queue_->run_one()) {
+                backoff = std::chrono::microseconds{0};
+            } else {
+                backoff = std::min(backoff * 2 + std::chrono::microseconds{1},
+                                   std::chrono::microseconds{1000});
+            }
+        }
+    }
+    
+    T get() {
+        wait();
+        return future_.get();
+    }
+    
+    template<typename Rep, typename Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+        return future_.wait_for(timeout);
+    }
+    
+    // Plain std::future (blocking get) for code that stores std::future
+    operator std::future<T>() && { return std::move(future_); }
+};
+
 class ThreadPoolWithFutures {
 private:
     std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex queue_mutex_;
-    std::condition_variable condition_;
-    bool stop_;
+    BoundedTaskQueue tasks_;
     
 public:
-    explicit ThreadPoolWithFutures(size_t num_threads) : stop_(false) {
+    explicit ThreadPoolWithFutures(size_t num_threads, size_t queue_capacity = 0,
+                                   OverflowPolicy policy = OverflowPolicy::BLOCK)
+        : tasks_(queue_capacity, policy) {
         for (size_t i = 0; i < num_threads; ++i) {
             workers_.emplace_back([this]() {
-                while (true) {
-                    std::function<void()> task;
-                    
-                    {
-                        std::unique_lock<std::mutex> lock(queue_mutex_);
-                        condition_.wait(lock, [this]() {
-                            return stop_ || !tasks_.empty();
-                        });
-                        
-                        if (stop_ && tasks_.empty()) {
-                            return;
-                        }
-                        
-                        task = std::move(tasks_.front());
-                        tasks_.pop();
-                    }
-                    
-                    task();
+                while (auto task = tasks_.pop()) {
+                    (*task)();
                 }
             });
         }
     }
     
-    // Submit task and get future for result
+    // Submit task and get future for result. With REJECT a full queue
+    // throws; with DROP_OLDEST the evicted task's future reports
+    // std::future_errc::broken_promise.
     template<typename F, typename... Args>
     auto submit(F&& f, Args&&... args) 
-        -> std::future<typename std::invoke_result_t<F, Args...>> {
+        -> PoolFuture<task_result_t<F, Args...>> {
         
-        using return_type = typename std::invoke_result_t<F, Args...>;
+        // One InplaceTask holding the callable and a pool-allocated promise:
+        // no shared_ptr<packaged_task>, no std::function heap copy
+        auto [job, result] = package_task(std::forward<F>(f), std::forward<Args>(args)...);
         
-        // Create a packaged_task
-        auto task = std::make_shared<std::packaged_task<return_type()>>(
-            std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-        );
+        if (!tasks_.push(job)) {
+            throw std::runtime_error("Thread pool queue is full");
+        }
         
-        std::future<return_type> result = task->get_future();
+        return {std::move(result), tasks_};
+    }
+    
+    // Never blocks, drops or runs inline: empty if the queue is full
+    template<typename F, typename... Args>
+    auto try_submit(F&& f, Args&&... args)
+        -> std::optional<PoolFuture<task_result_t<F, Args...>>> {
         
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            
-            if (stop_) {
-                throw std::runtime_error("Cannot submit to stopped pool");
-            }
-            
-            tasks_.emplace([task]() { (*task)(); });
+        auto [job, result] = package_task(std::forward<F>(f), std::forward<Args>(args)...);
+        
+        if (!tasks_.push(job, OverflowPolicy::REJECT)) {
+            return std::nullopt;
         }
         
-        condition_.notify_one();
-        return result;
+        return PoolFuture<task_result_t<F, Args...>>(std::move(result), tasks_);
     }
     
-    ~ThreadPoolWithFutures() {
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            stop_ = true;
+    // Fire-and-forget: no promise, no future. The task must not throw.
+    void post(InplaceTask task) {
+        if (!tasks_.push(task)) {
+            throw std::runtime_error("Thread pool queue is full");
         }
-        
-        condition_.notify_all();
+    }
+    
+    // Runs one queued task on the calling thread; false if there was none
+    bool try_run_one() { return tasks_.run_one(); }
+    
+    BackpressureStats stats() const { return tasks_.stats(); }
+    
+    ~ThreadPoolWithFutures() {
+        tasks_.shutdown();
         
         for (std::thread& worker : workers_) {
             if (worker.joinable()) {
@@ -207,6 +442,135 @@ public:
     }
 };
 
+// spawn/sync fork-join on ThreadPoolWithFutures (Cilk-style):
+//     ForkJoinScope scope(pool);
+//     scope.spawn([&] { left = solve(lhs); });
+//     right = solve(rhs);             // Parent continues with one half
+//     scope.sync();                   // Helps run queued tasks until done
+// sync() never parks a worker while runnable work exists, so recursive
+// divide-and-conquer uses every worker and cannot deadlock. The first
+// exception thrown by a spawned task is rethrown from sync(). A spawn that
+// a DROP_OLDEST pool evicts unrun also makes sync() throw; one that the
+// pool refuses (stopped, or REJECT and full) throws from spawn() itself.
+class ForkJoinScope {
+private:
+    ThreadPoolWithFutures& pool_;
+    size_t pending_ = 0;  // Guarded by mutex_
+    size_t dropped_ = 0;  // Guarded by mutex_
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::exception_ptr error_;
+    
+    // Counts one spawn in pending_ for as long as it lives. Travels inside
+    // the queued task, so a task destroyed without running still settles.
+    class Completion {
+    public:
+        explicit Completion(ForkJoinScope* scope) : scope_(scope) {
+            std::lock_guard<std::mutex> lock(scope_->mutex_);
+            ++scope_->pending_;
+        }
+        
+        Completion(Completion&& other) noexcept
+            : scope_(std::exchange(other.scope_, nullptr)) {}
+        Completion& operator=(Completion&&) = delete;
+        
+        ~Completion() {
+            if (scope_ != nullptr) {
+                scope_->finish(nullptr, true);
+            }
+        }
+        
+        void ran(std::exception_ptr error) {
+            std::exchange(scope_, nullptr)->finish(error, false);
+        }
+        
+    private:
+        ForkJoinScope* scope_;
+    };
+    
+public:
+    explicit ForkJoinScope(ThreadPoolWithFutures& pool) : pool_(pool) {}
+    
+    ForkJoinScope(const ForkJoinScope&) = delete;
+    ForkJoinScope& operator=(const ForkJoinScope&) = delete;
+    
+    template<typename F>
+    void spawn(F&& f) {
+        try {
+            Completion done(this);
+            pool_.post([done = std::move(done), fn = std::forward<F>(f)]() mutable {
+                std::exception_ptr error;
+                try {
+                    fn();
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                done.ran(error);
+            });
+        } catch (...) {
+            // Never queued: done has already settled it, but as a refusal
+            // reported here rather than a drop reported by sync()
+            std::lock_guard<std::mutex> lock(mutex_);
+            --dropped_;
+            throw;
+        }
+    }
+    
+    void sync() {
+        wait_all();
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_) {
+            std::exception_ptr error = std::exchange(error_, nullptr);
+            std::rethrow_exception(error);
+        }
+        if (dropped_ != 0) {
+            const size_t dropped = std::exchange(dropped_, 0);
+            throw std::runtime_error("ForkJoinScope: " + std::to_string(dropped) +
+                                     " spawned task(s) dropped unrun by the pool");
+        }
+    }
+    
+    ~ForkJoinScope() {
+        wait_all();  // Children reference the parent's stack: always join
+    }
+    
+private:
+    // Notifies under the lock: once sync() sees pending_ == 0 the scope may
+    // be destroyed, so nothing may touch it afterwards
+    void finish(std::exception_ptr error, bool dropped) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error && !error_) {
+            error_ = error;
+        }
+        if (dropped) {
+            ++dropped_;
+        }
+        if (--pending_ == 0) {
+            done_.notify_all();
+        }
+    }
+    
+    void wait_all() {
+        std::chrono::microseconds backoff{0};
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (done_.wait_for(lock, backoff, [this]() { return pending_ == 0; })) {
+                    return;
+                }
+            }
+            
+            if (pool_.try_run_one()) {
+                backoff = std::chrono::microseconds{0};
+            } else {
+                backoff = std::min(backoff * 2 + std::chrono::microseconds{1},
+                                   std::chrono::microseconds{1000});
+            }
+        }
+    }
+};
+
 void demonstrate_thread_pool_with_futures() {
     std::cout << "\n" << std::string(70, '=') << "\n";
     std::cout << "=== 2. Thread Pool with Futures (Return Values) ===\n";
@@ -238,6 +602,71 @@ void demonstrate_thread_pool_with_futures() {
     std::cout << "\n✓ All tasks returned results via std::future\n";
 }
 
+// Recursive parallel sum: every level submits one half and waits for it
+long long tree_sum(ThreadPoolWithFutures& pool, const std::vector<int>& values,
+                   size_t lo, size_t hi) {
+    if (hi - lo <= 4096) {
+        return std::accumulate(values.begin() + lo, values.begin() + hi, 0LL);
+    }
+    
+    size_t mid = lo + (hi - lo) / 2;
+    auto left = pool.submit([&pool, &values, lo, mid]() {
+        return tree_sum(pool, values, lo, mid);
+    });
+    long long right = tree_sum(pool, values, mid, hi);
+    
+    return left.get() + right;  // Runs queued tasks instead of blocking
+}
+
+void fork_join_quicksort(ThreadPoolWithFutures& pool, int* first, int* last) {
+    if (last - first <= 4096) {
+        std::sort(first, last);
+        return;
+    }
+    
+    int pivot = first[(last - first) / 2];
+    int* less_end = std::partition(first, last, [pivot](int x) { return x < pivot; });
+    int* equal_end = std::partition(less_end, last, [pivot](int x) { return !(pivot < x); });
+    
+    ForkJoinScope scope(pool);
+    scope.spawn([&pool, first, less_end]() { fork_join_quicksort(pool, first, less_end); });
+    fork_join_quicksort(pool, equal_end, last);
+    scope.sync();
+}
+
+void demonstrate_nested_fork_join() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 2a. Nested Fork-Join without Deadlock ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    std::cout << "Problem: a task that blocks in future.get() on its own child holds\n";
+    std::cout << "         a worker; recursion deeper than the pool size deadlocks\n";
+    std::cout << "Fix:     PoolFuture::get() and ForkJoinScope::sync() run queued\n";
+    std::cout << "         tasks while they wait\n\n";
+    
+    ThreadPoolWithFutures pool(2);  // Far fewer workers than recursion levels
+    
+    std::vector<int> values(1'000'000);
+    std::iota(values.begin(), values.end(), 0);
+    
+    auto sum = pool.submit([&pool, &values]() {
+        return tree_sum(pool, values, 0, values.size());
+    }).get();
+    std::cout << "  tree_sum (8 levels, PoolFuture::get): " << sum
+              << (sum == 999'999LL * 1'000'000 / 2 ? "  ✓" : "  ✗") << "\n";
+    
+    std::mt19937 rng(3);
+    std::shuffle(values.begin(), values.end(), rng);
+    pool.submit([&pool, &values]() {
+        fork_join_quicksort(pool, values.data(), values.data() + values.size());
+    }).get();
+    std::cout << "  fork_join_quicksort (spawn/sync):     sorted = " << std::boolalpha
+              << std::is_sorted(values.begin(), values.end()) << std::noboolalpha << "\n";
+    
+    std::cout << "\n✓ 2 workers, hundreds of nested waits, no deadlock\n";
+    std::cout << "✓ Waiting threads do useful work instead of sleeping\n";
+}
+
 // ============================================================================
 // SECTION 3: Thread Pool with Priority Queue
 // ============================================================================
@@ -249,134 +678,2070 @@ enum class TaskPriority {
     CRITICAL = 3
 };
 
-struct PrioritizedTask {
-    std::function<void()> func;
-    TaskPriority priority;
-    int sequence;  // For FIFO within same priority
-    
-    bool operator<(const PrioritizedTask& other) const {
-        if (priority != other.priority) {
-            return priority < other.priority;  // Higher priority first
-        }
-        return sequence > other.sequence;  // FIFO for same priority
-    }
-};
+constexpr size_t kPriorityLevels = 4;
 
-class PriorityThreadPool {
+// Bounded MPMC queue (Vyukov). Each cell carries a sequence number that
+// says whether it is free for the producer at position pos (seq == pos)
+// or holds data for the consumer at pos (seq == pos + 1). One CAS on the
+// shared position claims a cell, and there is no mutex. Each cell also
+// stores the time its value was enqueued, so the scheduler can see how
+// long the head has waited without popping it.
+template<typename T>
+class MpmcQueue {
 private:
-    std::vector<std::thread> workers_;
-    std::priority_queue<PrioritizedTask> tasks_;
-    std::mutex queue_mutex_;
-    std::condition_variable condition_;
-    bool stop_;
-    std::atomic<int> sequence_counter_;
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence;
+        std::atomic<int64_t> enqueued_ns;  // Atomic: peeked by other threads
+        T data;
+    };
+    
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
     
 public:
-    explicit PriorityThreadPool(size_t num_threads) 
-        : stop_(false), sequence_counter_(0) {
-        
-        for (size_t i = 0; i < num_threads; ++i) {
-            workers_.emplace_back([this]() {
-                while (true) {
-                    PrioritizedTask task{{}, TaskPriority::NORMAL, 0};
-                    
-                    {
-                        std::unique_lock<std::mutex> lock(queue_mutex_);
-                        condition_.wait(lock, [this]() {
-                            return stop_ || !tasks_.empty();
-                        });
-                        
-                        if (stop_ && tasks_.empty()) {
-                            return;
+    explicit MpmcQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) {
+            n <<= 1;
+        }
+        cells_ = std::make_unique<Cell[]>(n);
+        mask_ = n - 1;
+        for (size_t i = 0; i < n; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    // False if the queue is full; value is left untouched in that case
+    bool try_push(T& value, int64_t now_ns) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = std::move(value);
+                    cell.enqueued_ns.store(now_ns, std::memory_order_relaxed);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // The cell a full lap ahead is still occupied
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    bool try_pop(T& out) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(cell.data);
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Empty (or the producer has not published yet)
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    // Enqueue time of the current head, or -1 if there is none. A hint:
+    // the head may be taken by another consumer right after the peek.
+    int64_t head_enqueued_ns() const {
+        size_t pos = dequeue_pos_.load(std::memory_order_acquire);
+        const Cell& cell = cells_[pos & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return -1;
+        }
+        return cell.enqueued_ns.load(std::memory_order_relaxed);
+    }
+    
+    // Counts claimed-but-unpublished pushes as non-empty, which is the safe
+    // direction for the scheduler's bitmap re-check
+    bool empty() const {
+        return enqueue_pos_.load(std::memory_order_seq_cst) ==
+               dequeue_pos_.load(std::memory_order_seq_cst);
+    }
+};
+
+// Multi-level priority pool: one lock-free queue per TaskPriority and a
+// bitmap of levels that may be non-empty. A worker picks the highest set
+// bit, so choosing a level is one load and one bit scan. Submit and pop on
+// different levels touch different cache lines; there is no global lock.
+//
+// Aging: with a non-zero aging interval, a task's effective priority grows
+// by one level per interval waited. A LOW task that has waited 3 × aging
+// longer than the oldest CRITICAL task runs before it, so a steady stream
+// of high-priority work cannot starve the lower levels. With aging = 0 the
+// order is strict.
+//
+// A submit to a full level runs queued tasks on the caller. A task that
+// submits does so from inside such a run, so on a worker this nests; past
+// kMaxCallerRunDepth the task goes to the level's overflow list instead,
+// which keeps the stack bounded and never waits on a full ring.
+class PriorityThreadPool {
+private:
+    struct alignas(64) Level {
+        explicit Level(size_t capacity) : queue(capacity) {}
+        MpmcQueue<InplaceTask> queue;
+        
+        // Rarely used: only when the ring is full at the nesting limit
+        std::mutex overflow_mutex;
+        RingQueue<InplaceTask> overflow;            // Guarded by overflow_mutex
+        std::atomic<size_t> overflow_size{0};
+        
+        void push_overflow(InplaceTask& task) {
+            std::lock_guard<std::mutex> lock(overflow_mutex);
+            overflow.push(std::move(task));
+            overflow_size.fetch_add(1, std::memory_order_seq_cst);
+        }
+        
+        bool try_pop_overflow(InplaceTask& out) {
+            if (overflow_size.load(std::memory_order_acquire) == 0) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(overflow_mutex);
+            if (overflow.empty()) {
+                return false;
+            }
+            out = std::move(overflow.front());
+            overflow.pop();
+            overflow_size.fetch_sub(1, std::memory_order_seq_cst);
+            return true;
+        }
+        
+        bool empty() const {
+            return queue.empty() && overflow_size.load(std::memory_order_seq_cst) == 0;
+        }
+    };
+    
+    std::vector<std::unique_ptr<Level>> levels_;
+    alignas(64) std::atomic<uint32_t> nonempty_{0};  // Bit L: level L may hold tasks
+    
+    std::chrono::nanoseconds aging_;
+    std::atomic<size_t> promotions_{0};
+    std::atomic<size_t> caller_runs_{0};  // Tasks run by submit() on a full level
+    
+    // Same futex parking protocol as WorkStealingThreadPool::park()
+    alignas(64) std::atomic<uint32_t> wake_epoch_{0};
+    std::atomic<size_t> sleepers_{0};
+    std::atomic<bool> stop_{false};
+    
+    std::vector<std::thread> workers_;
+    
+    static constexpr int kSpinRounds = 64;
+    static constexpr int kMaxCallerRunDepth = 8;
+    
+    // Caller runs in progress on this thread (across pools)
+    static inline thread_local int caller_run_depth_ = 0;
+    
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    static int highest_bit(uint32_t mask) {
+        int level = 0;
+        while (mask >>= 1) {
+            ++level;
+        }
+        return level;
+    }
+    
+public:
+    // aging: 0 = strict priority. level_capacity bounds each level's queue;
+    // a submit to a full level runs queued tasks on the caller until a slot
+    // frees up (like OverflowPolicy::CALLER_RUNS, but keeping the order).
+    explicit PriorityThreadPool(size_t num_threads,
+                                std::chrono::microseconds aging = std::chrono::microseconds{0},
+                                size_t level_capacity = 1024)
+        : aging_(aging) {
+        for (size_t l = 0; l < kPriorityLevels; ++l) {
+            levels_.push_back(std::make_unique<Level>(level_capacity));
+        }
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back([this]() { worker_loop(); });
+        }
+    }
+    
+    PriorityThreadPool(const PriorityThreadPool&) = delete;
+    PriorityThreadPool& operator=(const PriorityThreadPool&) = delete;
+    
+    void submit(InplaceTask task, TaskPriority priority = TaskPriority::NORMAL) {
+        if (stop_.load(std::memory_order_relaxed)) {
+            throw std::runtime_error("Cannot submit to stopped pool");
+        }
+        
+        const auto level = static_cast<size_t>(priority);
+        const uint32_t bit = 1u << level;
+        
+        Level& target = *levels_[level];
+        while (!target.queue.try_push(task, now_ns())) {
+            if (caller_run_depth_ >= kMaxCallerRunDepth) {
+                target.push_overflow(task);
+                break;
+            }
+            ++caller_run_depth_;
+            bool ran;
+            try {
+                ran = run_one();
+            } catch (...) {
+                --caller_run_depth_;
+                throw;
+            }
+            --caller_run_depth_;
+            if (ran) {
+                caller_runs_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        
+        nonempty_.fetch_or(bit, std::memory_order_seq_cst);
+        
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+            wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+            wake_epoch_.notify_one();
+        }
+    }
+    
+    // Times a lower level ran ahead of a higher non-empty one due to aging
+    size_t promotions() const { return promotions_.load(std::memory_order_relaxed); }
+    size_t caller_runs() const { return caller_runs_.load(std::memory_order_relaxed); }
+    
+    // Runs one queued task on the calling thread; false if all levels are empty
+    bool run_one() {
+        InplaceTask task;
+        if (!take(task)) {
+            return false;
+        }
+        task();
+        return true;
+    }
+    
+    ~PriorityThreadPool() {
+        stop_.store(true, std::memory_order_seq_cst);
+        wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+        wake_epoch_.notify_all();
+        
+        // Workers drain every level before they exit
+        for (std::thread& worker : workers_) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+    
+private:
+    bool take(InplaceTask& out) {
+        for (;;) {
+            uint32_t mask = nonempty_.load(std::memory_order_seq_cst);
+            if (mask == 0) {
+                return false;
+            }
+            
+            int level = highest_bit(mask);
+            if (aging_.count() > 0) {
+                level = aged_level(mask, level);
+            }
+            
+            Level& chosen = *levels_[static_cast<size_t>(level)];
+            if (chosen.queue.try_pop(out) || chosen.try_pop_overflow(out)) {
+                return true;
+            }
+            
+            // The level looked non-empty but was not: clear its bit, then
+            // re-check so that a push racing with the clear is not lost
+            const uint32_t bit = 1u << level;
+            nonempty_.fetch_and(~bit, std::memory_order_seq_cst);
+            if (!chosen.empty()) {
+                nonempty_.fetch_or(bit, std::memory_order_seq_cst);
+            }
+        }
+    }
+    
+    // Effective priority = level + head wait / aging. Highest wins; on a tie
+    // the higher base level wins.
+    int aged_level(uint32_t mask, int top) {
+        const int64_t now = now_ns();
+        const double aging = static_cast<double>(aging_.count());
+        
+        int best = top;
+        double best_score = -1.0;
+        for (int level = top; level >= 0; --level) {
+            if (!(mask & (1u << level))) {
+                continue;
+            }
+            int64_t enqueued = levels_[static_cast<size_t>(level)]->queue.head_enqueued_ns();
+            if (enqueued < 0) {
+                continue;
+            }
+            double score = level + static_cast<double>(now - enqueued) / aging;
+            if (score > best_score) {
+                best_score = score;
+                best = level;
+            }
+        }
+        
+        if (best != top) {
+            promotions_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return best;
+    }
+    
+    void worker_loop() {
+        for (;;) {
+            bool ran = run_one();
+            for (int spin = 0; !ran && spin < kSpinRounds; ++spin) {
+                std::this_thread::yield();
+                ran = run_one();
+            }
+            if (ran) {
+                continue;
+            }
+            
+            if (stop_.load(std::memory_order_seq_cst) &&
+                nonempty_.load(std::memory_order_seq_cst) == 0) {
+                return;
+            }
+            park();
+        }
+    }
+    
+    void park() {
+        uint32_t epoch = wake_epoch_.load(std::memory_order_seq_cst);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        
+        if (nonempty_.load(std::memory_order_seq_cst) == 0 &&
+            !stop_.load(std::memory_order_seq_cst)) {
+            wake_epoch_.wait(epoch, std::memory_order_seq_cst);
+        }
+        
+        sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+};
+
+void demonstrate_priority_thread_pool() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 3. Priority Thread Pool ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    std::cout << "Concept: Higher priority tasks execute before lower priority ones\n";
+    std::cout << "Design:  One lock-free queue per level + bitmap of non-empty levels\n\n";
+    
+    {
+        PriorityThreadPool pool(2);
+        
+        std::cout << "Submitting tasks with different priorities...\n\n";
+        
+        // Submit in mixed order
+        pool.submit([]() {
+            std::cout << "  [NORMAL] Task 1\n";
+            std::this_thread::sleep_for(100ms);
+        }, TaskPriority::NORMAL);
+        
+        pool.submit([]() {
+            std::cout << "  [CRITICAL] Urgent task!\n";
+            std::this_thread::sleep_for(100ms);
+        }, TaskPriority::CRITICAL);
+        
+        pool.submit([]() {
+            std::cout << "  [LOW] Background task\n";
+            std::this_thread::sleep_for(100ms);
+        }, TaskPriority::LOW);
+        
+        pool.submit([]() {
+            std::cout << "  [HIGH] Important task\n";
+            std::this_thread::sleep_for(100ms);
+        }, TaskPriority::HIGH);
+        
+        pool.submit([]() {
+            std::cout << "  [NORMAL] Task 2\n";
+            std::this_thread::sleep_for(100ms);
+        }, TaskPriority::NORMAL);
+        
+        std::this_thread::sleep_for(1s);
+    }
+    
+    std::cout << "\nAging (20ms per level): one worker, a LOW task queued behind\n";
+    std::cout << "HIGH tasks (15ms each) arriving every 10ms\n\n";
+    {
+        PriorityThreadPool pool(1, 20ms);
+        std::atomic<bool> low_done{false};
+        std::atomic<int> high_before_low{0};
+        auto high_task = [&low_done, &high_before_low]() {
+            if (!low_done) {
+                ++high_before_low;
+            }
+            std::this_thread::sleep_for(15ms);
+        };
+        
+        pool.submit(high_task, TaskPriority::HIGH);
+        pool.submit([&low_done]() {
+            std::cout << "  [LOW] ran while HIGH work was still queued\n";
+            low_done = true;
+        }, TaskPriority::LOW);
+        for (int i = 0; i < 12; ++i) {
+            std::this_thread::sleep_for(10ms);
+            pool.submit(high_task, TaskPriority::HIGH);
+        }
+        
+        while (!low_done) {
+            std::this_thread::sleep_for(1ms);
+        }
+        std::cout << "  HIGH tasks that ran first: " << high_before_low << " of 13"
+                  << " (strict priority: 13), promotions: " << pool.promotions() << "\n";
+    }
+    
+    std::cout << "\n✓ Tasks executed by priority: CRITICAL → HIGH → NORMAL → LOW\n";
+    std::cout << "✓ Aging bounds how long a lower level can be starved\n";
+}
+
+// ============================================================================
+// SECTION 4: Work-Stealing Thread Pool (Advanced)
+// ============================================================================
+
+// Chase-Lev work-stealing deque (Chase & Lev 2005, C11 memory model version
+// from Le et al. 2013). The owning worker pushes and pops at the bottom
+// without any lock; thieves take from the top with a single CAS.
+//   - Owner pop is LIFO (hot caches, recursive tasks finish depth-first)
+//   - Steal is FIFO (thieves take the oldest, usually largest, work)
+// Elements must be trivially copyable - the pool stores task pointers.
+template<typename T>
+class ChaseLevDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "ChaseLevDeque stores raw slots");
+    
+    struct RingBuffer {
+        explicit RingBuffer(int64_t capacity)
+            : capacity(capacity), mask(capacity - 1),
+              slots(std::make_unique<std::atomic<T>[]>(static_cast<size_t>(capacity))) {}
+        
+        T get(int64_t i) const {
+            return slots[static_cast<size_t>(i & mask)].load(std::memory_order_relaxed);
+        }
+        void put(int64_t i, T value) {
+            slots[static_cast<size_t>(i & mask)].store(value, std::memory_order_relaxed);
+        }
+        
+        int64_t capacity;
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+    
+    alignas(64) std::atomic<int64_t> top_{0};      // Thieves' end
+    alignas(64) std::atomic<int64_t> bottom_{0};   // Owner's end
+    std::atomic<RingBuffer*> buffer_;
+    // Thieves may still read a buffer after it has been replaced, so old
+    // buffers are retired here and only freed with the deque (owner only).
+    std::vector<std::unique_ptr<RingBuffer>> buffers_;
+    
+public:
+    explicit ChaseLevDeque(int64_t initial_capacity = 256) {
+        buffers_.push_back(std::make_unique<RingBuffer>(initial_capacity));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+    
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+    
+    // Owner only
+    void push(T value) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        RingBuffer* buf = buffer_.load(std::memory_order_relaxed);
+        
+        if (b - t > buf->capacity - 1) {
+            buf = grow(buf, b, t);
+        }
+        
+        buf->put(b, value);
+        // Release store (rather than fence + relaxed store) publishes the
+        // slot and the task it points to to thieves' acquire load of bottom_
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+    
+    // Owner only
+    std::optional<T> pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        RingBuffer* buf = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        
+        if (t > b) {
+            // Deque was empty
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        
+        T value = buf->get(b);
+        if (t == b) {
+            // Last element: race against thieves for it
+            bool won = top_.compare_exchange_strong(t, t + 1,
+                                                    std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            if (!won) {
+                return std::nullopt;
+            }
+        }
+        return value;
+    }
+    
+    // Any thread
+    std::optional<T> steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        
+        if (t >= b) {
+            return std::nullopt;
+        }
+        
+        RingBuffer* buf = buffer_.load(std::memory_order_acquire);
+        T value = buf->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1,
+                                          std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return std::nullopt;  // Lost the race to another thief or the owner
+        }
+        return value;
+    }
+    
+    // Approximate; only used as a hint
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+    
+    // Approximate; for statistics
+    size_t size() const {
+        int64_t n = bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+    
+private:
+    RingBuffer* grow(RingBuffer* old, int64_t b, int64_t t) {
+        auto bigger = std::make_unique<RingBuffer>(old->capacity * 2);
+        for (int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        RingBuffer* raw = bigger.get();
+        buffers_.push_back(std::move(bigger));
+        buffer_.store(raw, std::memory_order_release);
+        return raw;
+    }
+};
+
+class WorkStealingThreadPool {
+private:
+    // Deque slots hold pointers; the task nodes themselves come from
+    // TaskBlockPool so a submit does not touch the global allocator
+    using Task = InplaceTask;
+    
+    struct alignas(64) WorkerThread {
+        ChaseLevDeque<Task*> local_queue;
+        std::thread thread;
+        std::vector<int> cpus;  // Empty = unpinned
+        // Steal order: workers on this worker's socket first, then the rest.
+        // Unpinned workers know no socket and treat every worker as near.
+        std::vector<size_t> near_victims;
+        std::vector<size_t> far_victims;
+        WorkerCounters counters;
+    };
+    
+    std::vector<std::unique_ptr<WorkerThread>> workers_;
+    std::vector<size_t> all_victims_;  // For external helpers in try_run_one()
+    
+    // Chase-Lev push is owner-only, so submissions from non-worker threads
+    // land in a shared injection queue that idle workers drain.
+    std::mutex injection_mutex_;
+    RingQueue<Task*> injection_queue_;
+    std::atomic<size_t> injection_size_{0};
+    
+    // Parking: idle workers sleep on a futex (std::atomic::wait) instead of
+    // polling. Producers bump the epoch and wake exactly one sleeper.
+    std::atomic<uint32_t> wake_epoch_{0};
+    std::atomic<size_t> sleepers_{0};
+    std::atomic<bool> stop_{false};
+    
+    static constexpr int kSpinRounds = 64;
+    static constexpr size_t kNotAWorker = SIZE_MAX;
+    
+    static thread_local WorkStealingThreadPool* current_pool_;
+    static thread_local size_t current_index_;
+    
+public:
+    explicit WorkStealingThreadPool(size_t num_threads, bool verbose = true,
+                                    const ThreadPlacement& placement = {}) {
+        if (verbose) {
+            std::cout << "  Creating work-stealing pool with " << num_threads << " workers\n";
+        }
+        
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.push_back(std::make_unique<WorkerThread>());
+            workers_[i]->cpus = placement.cpus_for(i);
+            all_victims_.push_back(i);
+        }
+        
+        for (size_t i = 0; i < num_threads; ++i) {
+            const int socket = ThreadPlacement::socket_of(workers_[i]->cpus);
+            for (size_t j = 0; j < num_threads; ++j) {
+                if (j == i) continue;
+                const int other = ThreadPlacement::socket_of(workers_[j]->cpus);
+                bool near = socket < 0 || other < 0 || other == socket;
+                (near ? workers_[i]->near_victims : workers_[i]->far_victims).push_back(j);
+            }
+        }
+        
+        // Start threads only after every deque exists: thieves index workers_
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_[i]->thread = std::thread([this, i, verbose]() {
+                WorkerThread& self = *workers_[i];
+                if (!self.cpus.empty()) {
+                    self.counters.pinned.store(pin_current_thread(self.cpus));
+                }
+                if (verbose) {
+                    std::cout << "    Worker " << i << " started\n";
+                }
+                worker_loop(i);
+            });
+        }
+    }
+    
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+    
+    void submit(InplaceTask task) {
+        Task* item = new (TaskBlockPool::allocate(sizeof(Task))) Task(std::move(task));
+        
+        if (current_pool_ == this) {
+            // Called from one of our workers (e.g. recursive task): lock-free
+            WorkerThread& self = *workers_[current_index_];
+            self.local_queue.push(item);
+            self.counters.saw_queue_depth(self.local_queue.size());
+        } else {
+            std::lock_guard<std::mutex> lock(injection_mutex_);
+            injection_queue_.push(item);
+            injection_size_.fetch_add(1, std::memory_order_seq_cst);
+        }
+        
+        wake_one();
+    }
+    
+    size_t size() const { return workers_.size(); }
+    
+    std::vector<WorkerStats> worker_stats() const {
+        std::vector<WorkerStats> result;
+        for (size_t i = 0; i < workers_.size(); ++i) {
+            result.push_back(snapshot(i, workers_[i]->cpus, workers_[i]->counters));
+        }
+        return result;
+    }
+    
+    // Runs one queued task on the calling thread, if there is one. A thread
+    // waiting for pool work calls this instead of blocking, so nested
+    // parallel calls from inside a task cannot starve the pool.
+    bool try_run_one() {
+        thread_local uint64_t rng = 0x9E3779B97F4A7C15ULL;
+        const size_t index = current_pool_ == this ? current_index_ : kNotAWorker;
+        
+        Task* task = find_task(index, rng);
+        if (task == nullptr) {
+            return false;
+        }
+        
+        (*task)();
+        destroy_task(task);
+        if (index != kNotAWorker) {
+            workers_[index]->counters.ran_task();
+        }
+        return true;
+    }
+    
+    template<typename Predicate>
+    void help_until(Predicate done) {
+        while (!done()) {
+            if (!try_run_one()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    ~WorkStealingThreadPool() {
+        stop_.store(true, std::memory_order_seq_cst);
+        wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+        wake_epoch_.notify_all();
+        
+        for (auto& worker : workers_) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+        
+        // Tasks still queued at shutdown are discarded (same as before)
+        for (auto& worker : workers_) {
+            while (auto task = worker->local_queue.pop()) {
+                destroy_task(*task);
+            }
+        }
+        while (!injection_queue_.empty()) {
+            destroy_task(injection_queue_.front());
+            injection_queue_.pop();
+        }
+    }
+    
+private:
+    static void destroy_task(Task* task) noexcept {
+        task->~Task();
+        TaskBlockPool::deallocate(task, sizeof(Task));
+    }
+    
+    void worker_loop(size_t index) {
+        current_pool_ = this;
+        current_index_ = index;
+        
+        uint64_t rng = 0x9E3779B97F4A7C15ULL * (index + 1);
+        WorkerCounters& counters = workers_[index]->counters;
+        
+        // Idle time runs from the first failed search, through spinning and
+        // parking, until the next task is found
+        bool idle = false;
+        std::chrono::steady_clock::time_point idle_since;
+        
+        while (!stop_.load(std::memory_order_relaxed)) {
+            Task* task = find_task(index, rng);
+            
+            if (task == nullptr) {
+                if (!idle) {
+                    idle = true;
+                    idle_since = std::chrono::steady_clock::now();
+                }
+                for (int spin = 0; spin < kSpinRounds && task == nullptr; ++spin) {
+                    std::this_thread::yield();
+                    task = find_task(index, rng);
+                }
+            }
+            
+            if (task != nullptr) {
+                if (idle) {
+                    idle = false;
+                    counters.idle_for(std::chrono::steady_clock::now() - idle_since);
+                }
+                (*task)();
+                destroy_task(task);
+                counters.ran_task();
+                continue;
+            }
+            
+            park();
+        }
+        
+        current_pool_ = nullptr;
+    }
+    
+    Task* find_task(size_t index, uint64_t& rng) {
+        // 1. Own deque (LIFO, no lock) - only workers have one
+        if (index != kNotAWorker) {
+            if (auto task = workers_[index]->local_queue.pop()) {
+                return *task;
+            }
+        }
+        
+        // 2. Shared injection queue (external submissions)
+        if (injection_size_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(injection_mutex_);
+            if (!injection_queue_.empty()) {
+                Task* task = injection_queue_.front();
+                injection_queue_.pop();
+                injection_size_.fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+        
+        // 3. Steal: same-socket victims first, then the other sockets
+        Task* stolen = try_steal_work(index, rng);
+        if (stolen != nullptr && index != kNotAWorker) {
+            workers_[index]->counters.stole_task();
+        }
+        return stolen;
+    }
+    
+    Task* try_steal_work(size_t my_index, uint64_t& rng) {
+        if (my_index == kNotAWorker) {
+            return steal_from(all_victims_, rng);
+        }
+        
+        // A cross-socket steal moves the task's data over the interconnect,
+        // so the far group is only tried once every near deque is empty
+        const WorkerThread& self = *workers_[my_index];
+        if (Task* task = steal_from(self.near_victims, rng)) {
+            return task;
+        }
+        return steal_from(self.far_victims, rng);
+    }
+    
+    // Starts at a random victim, then sweeps the rest of the group
+    Task* steal_from(const std::vector<size_t>& victims, uint64_t& rng) {
+        const size_t n = victims.size();
+        if (n == 0) {
+            return nullptr;
+        }
+        
+        // xorshift64: cheap per-worker random victim avoids every thief
+        // hammering worker 0 first
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        const size_t start = static_cast<size_t>(rng % n);
+        
+        for (size_t k = 0; k < n; ++k) {
+            if (auto task = workers_[victims[(start + k) % n]]->local_queue.steal()) {
+                return *task;
+            }
+        }
+        
+        return nullptr;
+    }
+    
+    bool has_visible_work() const {
+        if (injection_size_.load(std::memory_order_seq_cst) > 0) {
+            return true;
+        }
+        for (const auto& worker : workers_) {
+            if (!worker->local_queue.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void park() {
+        // Event-count protocol: read the epoch, announce ourselves as a
+        // sleeper, re-check for work, then wait for the epoch to change.
+        // A producer that pushed before our re-check is seen by it; one that
+        // pushed after sees sleepers_ > 0 and bumps the epoch - no lost wakeups.
+        uint32_t epoch = wake_epoch_.load(std::memory_order_seq_cst);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        
+        if (!has_visible_work() && !stop_.load(std::memory_order_seq_cst)) {
+            wake_epoch_.wait(epoch, std::memory_order_seq_cst);
+        }
+        
+        sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+    
+    void wake_one() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+            wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+            wake_epoch_.notify_one();
+        }
+    }
+};
+
+thread_local WorkStealingThreadPool* WorkStealingThreadPool::current_pool_ = nullptr;
+thread_local size_t WorkStealingThreadPool::current_index_ = 0;
+
+void demonstrate_work_stealing_pool() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 4. Work-Stealing Thread Pool ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    std::cout << "Concept: Idle workers steal tasks from busy workers' queues\n";
+    std::cout << "Benefit: Better load balancing for uneven task durations\n";
+    std::cout << "Design:  Lock-free Chase-Lev deque per worker, idle workers\n";
+    std::cout << "         park on a futex and are woken only when work arrives\n\n";
+    
+    WorkStealingThreadPool pool(4);
+    
+    std::cout << "Submitting 12 tasks with varying durations...\n\n";
+    
+    for (int i = 1; i <= 12; ++i) {
+        pool.submit([i]() {
+            int duration = (i % 3 + 1) * 100;  // 100ms, 200ms, or 300ms
+            std::cout << "  Task " << i << " (duration: " << duration 
+                      << "ms) on thread " << std::this_thread::get_id() << "\n";
+            std::this_thread::sleep_for(std::chrono::milliseconds(duration));
+        });
+    }
+    
+    std::this_thread::sleep_for(2s);
+    
+    std::cout << "\n✓ Work stealing enabled better load distribution\n";
+    std::cout << "✓ Idle workers helped busy workers finish faster\n";
+}
+
+// ============================================================================
+// SECTION 5: Dynamic Thread Pool (Auto-scaling)
+// ============================================================================
+
+// When the pool grows and shrinks. Growing is cheap to undo, so it reacts
+// fast (cooldown in milliseconds). Shrinking waits out a much longer idle
+// timeout. That gap is the hysteresis: a worker that was just added for a
+// burst is not torn down by the first lull inside the same burst.
+struct ScalingPolicy {
+    // Workers above min_threads exit after this long without a task
+    std::chrono::milliseconds idle_timeout{500};
+    // Scale up when the smoothed queue wait exceeds this...
+    std::chrono::microseconds max_queue_wait{20000};
+    // ...or when more than this many tasks are queued per live worker
+    size_t backlog_per_worker = 2;
+    // Minimum time between two scale-ups
+    std::chrono::milliseconds scale_up_cooldown{20};
+};
+
+struct DynamicPoolStats {
+    size_t current_threads;
+    size_t peak_threads;
+    size_t retired_threads;   // Exited after idle_timeout, over the pool's lifetime
+    size_t idle_threads;
+    size_t queued_tasks;
+    size_t scale_ups;
+    double queue_wait_ms;     // Moving average of submit → start of execution
+};
+
+class DynamicThreadPool {
+private:
+    struct Worker {
+        std::thread thread;
+        size_t slot;            // Index into the placement; reused after retirement
+        std::vector<int> cpus;  // Empty = unpinned
+        WorkerCounters counters;
+        bool exited = false;    // Retired; thread is finishing, join it
+    };
+    
+    // Enqueue time travels with the task so a worker can measure queue wait
+    struct QueuedTask {
+        InplaceTask task;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+    
+    // Everything below is guarded by queue_mutex_
+    std::vector<std::unique_ptr<Worker>> workers_;
+    RingQueue<QueuedTask> tasks_;
+    std::mutex queue_mutex_;
+    std::condition_variable condition_;
+    bool stop_;
+    
+    size_t min_threads_;
+    size_t max_threads_;
+    ScalingPolicy policy_;
+    size_t live_threads_ = 0;
+    size_t peak_threads_ = 0;
+    size_t retired_threads_ = 0;
+    size_t scale_ups_ = 0;
+    double queue_wait_ewma_ns_ = 0;
+    std::chrono::steady_clock::time_point last_scale_up_{};
+    
+    std::atomic<size_t> active_threads_;
+    std::atomic<size_t> idle_threads_;
+    ThreadPlacement placement_;
+    bool verbose_;
+    
+public:
+    DynamicThreadPool(size_t min_threads, size_t max_threads,
+                      const ScalingPolicy& policy = {},
+                      const ThreadPlacement& placement = {}, bool verbose = true) 
+        : stop_(false), min_threads_(min_threads),
+          max_threads_(std::max(min_threads, max_threads)), policy_(policy),
+          active_threads_(0), idle_threads_(0), placement_(placement), verbose_(verbose) {
+        
+        if (verbose_) {
+            std::cout << "  Creating dynamic pool (min: " << min_threads 
+                      << ", max: " << max_threads_ << ")\n";
+        }
+        
+        // Start with minimum threads
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        for (size_t i = 0; i < min_threads_; ++i) {
+            add_worker();
+        }
+    }
+    
+    void submit(InplaceTask task) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            
+            if (stop_) {
+                throw std::runtime_error("Cannot submit to stopped pool");
+            }
+            
+            auto now = std::chrono::steady_clock::now();
+            tasks_.push({std::move(task), now});
+            maybe_scale_up(now);
+        }
+        
+        condition_.notify_one();
+    }
+    
+    DynamicPoolStats stats() {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        return {live_threads_, peak_threads_, retired_threads_, idle_threads_.load(),
+                tasks_.size(), scale_ups_, queue_wait_ewma_ns_ / 1e6};
+    }
+    
+    // One entry per live worker. Worker slots are reused after retirement,
+    // so a regrown pool lands on the same CPUs as before.
+    std::vector<WorkerStats> worker_stats() {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        std::vector<WorkerStats> result;
+        for (const auto& worker : workers_) {
+            if (!worker->exited) {
+                result.push_back(snapshot(worker->slot, worker->cpus, worker->counters));
+            }
+        }
+        return result;
+    }
+    
+    ~DynamicThreadPool() {
+        // Workers still draining the queue touch workers_ under the lock,
+        // so join from a copy taken once stop_ rules out any new worker
+        std::vector<std::unique_ptr<Worker>> workers;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            stop_ = true;
+            workers.swap(workers_);
+        }
+        
+        condition_.notify_all();
+        
+        for (auto& worker : workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+        
+        if (verbose_) {
+            std::cout << "  Dynamic pool destroyed\n";
+        }
+    }
+    
+private:
+    // Called with queue_mutex_ held, on submit and whenever a worker takes
+    // a task. Growing only helps if nobody is free to take the queued work
+    // and the queue is either deep or slow.
+    void maybe_scale_up(std::chrono::steady_clock::time_point now) {
+        if (stop_ || live_threads_ >= max_threads_ || tasks_.empty() || idle_threads_ > 0) {
+            return;
+        }
+        if (live_threads_ > 0 && now - last_scale_up_ < policy_.scale_up_cooldown) {
+            return;
+        }
+        
+        const bool deep = tasks_.size() > policy_.backlog_per_worker * live_threads_;
+        const bool slow = queue_wait_ewma_ns_ >
+            std::chrono::duration<double, std::nano>(policy_.max_queue_wait).count();
+        if (!deep && !slow) {
+            return;
+        }
+        
+        last_scale_up_ = now;
+        ++scale_ups_;
+        if (verbose_) {
+            std::cout << "  📈 Scaling up: adding worker (total: " << (live_threads_ + 1)
+                      << ", " << (deep ? "backlog " : "queue wait ")
+                      << (deep ? std::to_string(tasks_.size()) + " tasks"
+                               : std::to_string(static_cast<int>(queue_wait_ewma_ns_ / 1e6)) + "ms")
+                      << ")\n";
+        }
+        add_worker();
+    }
+    
+    // Called with queue_mutex_ held (or from the constructor). No-op once
+    // the destructor has taken workers_.
+    void add_worker() {
+        if (stop_) {
+            return;
+        }
+        reap_exited_workers();
+        
+        // Lowest placement slot not held by a live worker
+        size_t slot = 0;
+        while (std::any_of(workers_.begin(), workers_.end(),
+                           [slot](const auto& w) { return w->slot == slot; })) {
+            ++slot;
+        }
+        
+        workers_.push_back(std::make_unique<Worker>());
+        Worker& self = *workers_.back();
+        self.slot = slot;
+        self.cpus = placement_.cpus_for(slot);
+        
+        ++live_threads_;
+        peak_threads_ = std::max(peak_threads_, live_threads_);
+        
+        self.thread = std::thread([this, &self]() {
+            if (!self.cpus.empty()) {
+                self.counters.pinned.store(pin_current_thread(self.cpus));
+            }
+            worker_loop(self);
+        });
+    }
+    
+    // A retired worker sets exited under the lock and then only returns,
+    // so joining it here cannot deadlock on queue_mutex_
+    void reap_exited_workers() {
+        for (auto it = workers_.begin(); it != workers_.end();) {
+            if ((*it)->exited) {
+                (*it)->thread.join();
+                it = workers_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+    void worker_loop(Worker& self) {
+        while (true) {
+            InplaceTask task;
+            
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex_);
+                
+                ++idle_threads_;
+                auto waiting_since = std::chrono::steady_clock::now();
+                
+                bool has_work = condition_.wait_for(lock, policy_.idle_timeout, [this]() {
+                    return stop_ || !tasks_.empty();
+                });
+                
+                auto now = std::chrono::steady_clock::now();
+                self.counters.idle_for(now - waiting_since);
+                --idle_threads_;
+                
+                if (!has_work) {
+                    if (live_threads_ > min_threads_) {
+                        --live_threads_;
+                        ++retired_threads_;
+                        self.exited = true;
+                        if (verbose_) {
+                            std::cout << "  📉 Scaling down: idle worker retired (total: "
+                                      << live_threads_ << ")\n";
                         }
-                        
-                        task = tasks_.top();
-                        tasks_.pop();
+                        return;
                     }
-                    
-                    task.func();
+                    continue;
+                }
+                
+                if (stop_ && tasks_.empty()) {
+                    return;
+                }
+                
+                QueuedTask& next = tasks_.front();
+                double wait_ns = std::chrono::duration<double, std::nano>(now - next.enqueued).count();
+                queue_wait_ewma_ns_ += (wait_ns - queue_wait_ewma_ns_) / 8;
+                self.counters.saw_queue_depth(tasks_.size());
+                task = std::move(next.task);
+                tasks_.pop();
+                
+                // Tasks still waiting behind this one may justify another worker
+                // even if no new submit arrives
+                maybe_scale_up(now);
+            }
+            
+            ++active_threads_;
+            task();
+            --active_threads_;
+            self.counters.ran_task();
+        }
+    }
+};
+
+void print_dynamic_stats(const char* label, const DynamicPoolStats& s) {
+    std::cout << "  [" << label << "] threads: " << s.current_threads
+              << " (peak " << s.peak_threads << ", retired " << s.retired_threads
+              << "), queued: " << s.queued_tasks << ", scale-ups: " << s.scale_ups
+              << ", avg queue wait: " << std::fixed << std::setprecision(1)
+              << s.queue_wait_ms << "ms\n" << std::defaultfloat << std::setprecision(6);
+}
+
+void demonstrate_dynamic_thread_pool() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 5. Dynamic Thread Pool (Auto-scaling) ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    std::cout << "Concept: Pool grows/shrinks based on workload\n";
+    std::cout << "Policy:  grow on queue backlog or queue wait (20ms cooldown),\n";
+    std::cout << "         retire workers idle for 300ms, down to min_threads\n\n";
+    
+    ScalingPolicy policy;
+    policy.idle_timeout = 300ms;
+    DynamicThreadPool pool(2, 6, policy);
+    
+    std::cout << "Phase 1: Light load (2 tasks)\n\n";
+    
+    for (int i = 1; i <= 2; ++i) {
+        pool.submit([i]() {
+            std::cout << "  Light task " << i << "\n";
+            std::this_thread::sleep_for(200ms);
+        });
+    }
+    
+    std::this_thread::sleep_for(500ms);
+    print_dynamic_stats("light", pool.stats());
+    
+    std::cout << "\nPhase 2: Heavy load (10 tasks)\n\n";
+    
+    for (int i = 1; i <= 10; ++i) {
+        pool.submit([i]() {
+            std::cout << "  Heavy task " << i << "\n";
+            std::this_thread::sleep_for(300ms);
+        });
+        std::this_thread::sleep_for(50ms);  // Gradual submission
+    }
+    
+    print_dynamic_stats("heavy", pool.stats());
+    
+    std::cout << "\nPhase 3: Quiet (idle workers time out)\n\n";
+    std::this_thread::sleep_for(1500ms);
+    print_dynamic_stats("quiet", pool.stats());
+    
+    std::cout << "\n✓ Pool scaled up while tasks queued faster than workers drained them\n";
+    std::cout << "✓ Idle workers retired back to min_threads after the burst\n";
+    std::cout << "✓ Slow shrink + cooldown on growth = hysteresis, no thread churn\n";
+}
+
+void print_worker_stats(const std::vector<WorkerStats>& stats) {
+    std::cout << "  " << std::setw(6) << "Worker" << std::setw(8) << "CPUs"
+              << std::setw(8) << "Socket" << std::setw(8) << "Pinned"
+              << std::setw(8) << "Run" << std::setw(8) << "Stolen"
+              << std::setw(11) << "Idle ms" << std::setw(12) << "Queue peak" << "\n";
+    
+    for (const auto& w : stats) {
+        std::string cpus = "-";
+        if (!w.cpus.empty()) {
+            cpus.clear();
+            for (size_t i = 0; i < w.cpus.size(); ++i) {
+                if (i) cpus += ',';
+                cpus += std::to_string(w.cpus[i]);
+            }
+        }
+        std::cout << "  " << std::setw(6) << w.worker << std::setw(8) << cpus
+                  << std::setw(8) << w.socket << std::setw(8) << (w.pinned ? "yes" : "no")
+                  << std::setw(8) << w.tasks_run << std::setw(8) << w.tasks_stolen
+                  << std::setw(11) << std::fixed << std::setprecision(1) << w.idle_ms
+                  << std::setw(12) << w.queue_high_water << "\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+void demonstrate_thread_placement() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 5a. Thread Placement and Per-Worker Statistics ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    const CpuTopology& topology = CpuTopology::instance();
+    std::cout << "Topology: " << topology.cpus().size() << " usable CPUs on "
+              << topology.socket_count() << " socket(s)\n";
+    for (size_t i = 0; i < topology.cpus().size() && i < 8; ++i) {
+        const CpuInfo& cpu = topology.cpus()[i];
+        std::cout << "  cpu" << cpu.cpu << ": socket " << cpu.socket << ", core "
+                  << cpu.core << ", node " << cpu.node << "\n";
+    }
+    if (topology.cpus().size() > 8) {
+        std::cout << "  ...\n";
+    }
+    
+    std::cout << "\nWorker → CPU for the first 4 workers:\n";
+    auto show = [](const char* name, const ThreadPlacement& placement) {
+        std::cout << "  " << std::left << std::setw(9) << name << std::right;
+        for (size_t i = 0; i < 4; ++i) {
+            std::cout << " w" << i << "→cpu" << placement.cpus_for(i).front();
+        }
+        std::cout << "\n";
+    };
+    show("COMPACT", ThreadPlacement::compact());
+    show("SCATTER", ThreadPlacement::scatter());
+    
+    std::cout << "\nWork-stealing pool, COMPACT placement, recursive fan-out:\n";
+    std::cout << "(thieves try workers on their own socket before remote ones)\n\n";
+    {
+        WorkStealingThreadPool pool(4, false, ThreadPlacement::compact());
+        std::atomic<size_t> done{0};
+        const size_t roots = 8, children = 64;
+        
+        for (size_t r = 0; r < roots; ++r) {
+            pool.submit([&pool, &done]() {
+                for (size_t c = 0; c < children; ++c) {
+                    pool.submit([&done]() {
+                        std::this_thread::sleep_for(100us);
+                        done.fetch_add(1, std::memory_order_release);
+                    });
                 }
             });
         }
+        while (done.load(std::memory_order_acquire) < roots * children) {
+            std::this_thread::sleep_for(1ms);
+        }
+        print_worker_stats(pool.worker_stats());
+    }
+    
+    std::cout << "\nBasic pool, explicit core sets {0} and {0,1}:\n\n";
+    {
+        BasicThreadPool pool(2, 0, OverflowPolicy::BLOCK, ThreadPlacement::cores({{0}, {0, 1}}));
+        std::atomic<size_t> done{0};
+        for (int i = 0; i < 40; ++i) {
+            pool.submit([&done]() {
+                std::this_thread::sleep_for(1ms);
+                done.fetch_add(1, std::memory_order_release);
+            });
+        }
+        while (done.load(std::memory_order_acquire) < 40) {
+            std::this_thread::sleep_for(1ms);
+        }
+        std::cout << "\n";
+        print_worker_stats(pool.worker_stats());
+    }
+    
+    std::cout << "\n✓ Pinned workers keep their caches; COMPACT shares L3, SCATTER spreads memory bandwidth\n";
+    std::cout << "✓ Same-socket stealing keeps stolen work's data on the local NUMA node\n";
+    std::cout << "✓ Idle time and queue peaks show whether a pool is over- or under-sized\n";
+    std::cout << "✗ Pinning more workers than CPUs makes them share cores; size the pool first\n";
+}
+
+// ============================================================================
+// SECTION 6: Thread Pool Best Practices and Anti-Patterns
+// ============================================================================
+
+void demonstrate_best_practices() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 6. Thread Pool Best Practices ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    std::cout << "✓ BEST PRACTICES:\n";
+    std::cout << "─────────────────\n\n";
+    
+    std::cout << "1. Pool Size Selection:\n";
+    std::cout << "   CPU-bound: num_threads ≈ std::thread::hardware_concurrency()\n";
+    std::cout << "   I/O-bound: num_threads > CPU cores (2x-4x)\n";
+    std::cout << "   Mixed:     Profile and tune based on workload\n\n";
+    
+    std::cout << "2. Task Granularity:\n";
+    std::cout << "   ✓ Tasks should run for at least 1ms (avoid overhead)\n";
+    std::cout << "   ✗ Don't submit trivial tasks (e.g., single addition)\n";
+    std::cout << "   ✓ Batch small operations into larger tasks\n\n";
+    
+    std::cout << "3. Exception Handling:\n";
+    std::cout << "   ✓ Tasks should catch their own exceptions\n";
+    std::cout << "   ✓ Use std::future to propagate exceptions\n";
+    std::cout << "   ✗ Uncaught exceptions terminate worker threads\n\n";
+    
+    std::cout << "4. Shutdown:\n";
+    std::cout << "   ✓ Signal stop before destroying pool\n";
+    std::cout << "   ✓ Join all worker threads in destructor\n";
+    std::cout << "   ✓ Consider draining pending tasks gracefully\n\n";
+    
+    std::cout << "5. Task Dependencies:\n";
+    std::cout << "   ✗ DEADLOCK RISK: Task waiting for another task in same pool\n";
+    std::cout << "   ✓ Use separate pools for dependent tasks\n";
+    std::cout << "   ✓ Or ensure pool size > max dependency depth\n";
+    std::cout << "   ✓ Or wait by helping: PoolFuture / ForkJoinScope (see 2a)\n\n";
+    
+    std::cout << "❌ ANTI-PATTERNS:\n";
+    std::cout << "─────────────────\n\n";
+    
+    std::cout << "1. Too many pools: Creates thread explosion\n";
+    std::cout << "   ✗ One pool per operation type (100+ pools)\n";
+    std::cout << "   ✓ One global pool or few specialized pools\n\n";
+    
+    std::cout << "2. Blocking in tasks:\n";
+    std::cout << "   ✗ Task calls blocking I/O (starves other tasks)\n";
+    std::cout << "   ✓ Use async I/O or separate I/O thread pool\n\n";
+    
+    std::cout << "3. Long-running tasks:\n";
+    std::cout << "   ✗ Task runs for minutes/hours (blocks worker)\n";
+    std::cout << "   ✓ Break into smaller chunks or use dedicated thread\n\n";
+    
+    std::cout << "4. Unbounded queue growth:\n";
+    std::cout << "   ✗ Submit faster than processing (memory exhaustion)\n";
+    std::cout << "   ✓ Use bounded queue with backpressure (see 6a)\n\n";
+}
+
+const char* to_string(OverflowPolicy policy) {
+    switch (policy) {
+        case OverflowPolicy::BLOCK:       return "BLOCK";
+        case OverflowPolicy::REJECT:      return "REJECT";
+        case OverflowPolicy::DROP_OLDEST: return "DROP_OLDEST";
+        case OverflowPolicy::CALLER_RUNS: return "CALLER_RUNS";
     }
+    return "?";
+}
+
+void demonstrate_backpressure() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 6a. Bounded Queue with Backpressure ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    std::cout << "Scenario: 1 worker, queue capacity 2, producer bursts 8 tasks of 50ms\n\n";
     
-    void submit(std::function<void()> task, TaskPriority priority = TaskPriority::NORMAL) {
+    for (OverflowPolicy policy : {OverflowPolicy::BLOCK, OverflowPolicy::REJECT,
+                                  OverflowPolicy::DROP_OLDEST, OverflowPolicy::CALLER_RUNS}) {
+        std::atomic<int> executed{0};
+        BackpressureStats stats;
+        auto start = std::chrono::steady_clock::now();
+        
         {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
+            BasicThreadPool pool(1, 2, policy);
             
-            if (stop_) {
-                throw std::runtime_error("Cannot submit to stopped pool");
+            for (int i = 1; i <= 8; ++i) {
+                pool.submit([&executed]() {
+                    std::this_thread::sleep_for(50ms);
+                    ++executed;
+                });
             }
             
-            tasks_.push({std::move(task), priority, sequence_counter_++});
+            auto burst = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+            std::cout << "  " << std::left << std::setw(12) << to_string(policy) << std::right
+                      << " burst accepted in " << std::setw(3) << burst.count() << "ms\n";
+            
+            std::this_thread::sleep_for(500ms);  // Let the worker drain
+            stats = pool.stats();
         }
         
-        condition_.notify_one();
+        std::cout << "      executed " << executed << "/8"
+                  << "  queued " << stats.submitted
+                  << "  rejected " << stats.rejected
+                  << "  blocked " << stats.blocked
+                  << "  dropped " << stats.dropped
+                  << "  caller-ran " << stats.caller_runs << "\n\n";
     }
     
-    ~PriorityThreadPool() {
+    std::cout << "try_submit() never waits: returns false / empty optional when full\n";
+    ThreadPoolWithFutures futures_pool(1, 1, OverflowPolicy::REJECT);
+    auto first = futures_pool.try_submit([]() { std::this_thread::sleep_for(100ms); return 1; });
+    std::this_thread::sleep_for(10ms);  // Worker picks up the first task
+    auto second = futures_pool.try_submit([]() { return 2; });
+    auto third = futures_pool.try_submit([]() { return 3; });
+    std::cout << "  try_submit #1: " << (first ? "accepted" : "rejected")
+              << ", #2: " << (second ? "accepted" : "rejected")
+              << ", #3: " << (third ? "accepted" : "rejected") << "\n";
+    
+    std::cout << "\n✓ Memory bounded by capacity × task size, whatever the producer rate\n";
+    std::cout << "✓ BLOCK/CALLER_RUNS slow producers down; REJECT/DROP_OLDEST shed load\n";
+    std::cout << "✗ Never use BLOCK when workers submit to their own pool (deadlock)\n";
+}
+
+// ============================================================================
+// SECTION 7: Real-World Example - Image Processing Pipeline
+// ============================================================================
+
+// A stage-parallel streaming pipeline. A future barrier chain (submit every
+// load, get() every load, submit every filter, ...) makes each stage wait for
+// the slowest item of the previous one. Here each stage is a small group of
+// worker threads, and bounded channels connect consecutive stages, so items
+// flow through all stages at once. Steady-state throughput is set by the
+// slowest stage, not by the sum of the stages. A full channel blocks its
+// producer, which keeps memory bounded by capacity × stages.
+namespace pipeline {
+
+// Bounded blocking MPMC channel. close() is called by the last producer.
+// After that, pop() drains what is left and then returns nullopt.
+template<typename T>
+class Channel {
+private:
+    RingQueue<T> items_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    size_t capacity_;
+    size_t high_water_ = 0;
+    bool closed_ = false;
+    
+public:
+    explicit Channel(size_t capacity) : items_(capacity), capacity_(capacity) {}
+    
+    void push(T&& item) {
         {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            stop_ = true;
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this]() { return items_.size() < capacity_; });
+            items_.push(std::move(item));
+            high_water_ = std::max(high_water_, items_.size());
+        }
+        not_empty_.notify_one();
+    }
+    
+    std::optional<T> pop() {
+        std::optional<T> item;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+            if (items_.empty()) {
+                return std::nullopt;
+            }
+            item.emplace(std::move(items_.front()));
+            items_.pop();
+        }
+        not_full_.notify_one();
+        return item;
+    }
+    
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+    }
+    
+    size_t high_water() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return high_water_;
+    }
+};
+
+struct StageStats {
+    std::string name;
+    size_t parallelism;
+    size_t processed;
+    double busy_ms;          // Summed over the stage's workers
+    size_t input_high_water; // Deepest the stage's input channel got
+};
+
+// Type-erased view of a stage so a pipeline can own stages of different types
+class StageBase {
+public:
+    virtual ~StageBase() = default;
+    virtual void start() = 0;
+    virtual void join() = 0;
+    virtual StageStats stats() const = 0;
+};
+
+// Shared by all stages of one pipeline; keeps the first exception a stage threw
+struct ErrorSlot {
+    std::mutex mutex;
+    std::exception_ptr error;
+    
+    void capture() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+            error = std::current_exception();
+        }
+    }
+};
+
+// Out = void marks a sink: the stage consumes items and has no output channel
+template<typename In, typename Out, typename Fn>
+class Stage : public StageBase {
+private:
+    std::string name_;
+    size_t parallelism_;
+    Fn fn_;
+    std::shared_ptr<Channel<In>> input_;
+    std::shared_ptr<Channel<Out>> output_;
+    std::shared_ptr<ErrorSlot> errors_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> running_{0};
+    std::atomic<size_t> processed_{0};
+    std::atomic<int64_t> busy_ns_{0};
+    
+    void worker_loop() {
+        while (auto item = input_->pop()) {
+            auto start = std::chrono::steady_clock::now();
+            try {
+                if constexpr (std::is_void_v<Out>) {
+                    fn_(std::move(*item));
+                } else {
+                    output_->push(fn_(std::move(*item)));
+                }
+                processed_.fetch_add(1, std::memory_order_relaxed);
+            } catch (...) {
+                // The item is dropped; the pipeline keeps draining so that
+                // upstream producers never block on a channel nobody reads
+                errors_->capture();
+            }
+            busy_ns_.fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count(),
+                std::memory_order_relaxed);
         }
         
-        condition_.notify_all();
-        
-        for (std::thread& worker : workers_) {
-            if (worker.joinable()) {
-                worker.join();
+        // The last worker out closes the next channel, so the shutdown
+        // cascades down the pipeline once the source is closed
+        if (running_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            if constexpr (!std::is_void_v<Out>) {
+                output_->close();
             }
         }
     }
+    
+public:
+    Stage(std::string name, size_t parallelism, Fn fn,
+          std::shared_ptr<Channel<In>> input,
+          std::shared_ptr<Channel<Out>> output,
+          std::shared_ptr<ErrorSlot> errors)
+        : name_(std::move(name)), parallelism_(std::max<size_t>(1, parallelism)),
+          fn_(std::move(fn)), input_(std::move(input)), output_(std::move(output)),
+          errors_(std::move(errors)) {}
+    
+    void start() override {
+        running_.store(parallelism_, std::memory_order_relaxed);
+        for (size_t i = 0; i < parallelism_; ++i) {
+            workers_.emplace_back([this]() { worker_loop(); });
+        }
+    }
+    
+    void join() override {
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        workers_.clear();
+    }
+    
+    StageStats stats() const override {
+        return {name_, parallelism_, processed_.load(),
+                busy_ns_.load() / 1e6, input_->high_water()};
+    }
+};
+
+template<typename Source>
+class RunningPipeline;
+
+// Builder: Pipeline<Source, Current> accepts Source items and currently
+// produces Current. Each then() adds a typed stage; sink() adds the last stage
+// and starts every worker. Payloads are moved from stage to stage, so
+// move-only types work and nothing is copied.
+template<typename Source, typename Current = Source>
+class Pipeline {
+private:
+    template<typename, typename> friend class Pipeline;
+    
+    size_t capacity_;
+    std::shared_ptr<Channel<Source>> source_;
+    std::shared_ptr<Channel<Current>> tail_;
+    std::shared_ptr<ErrorSlot> errors_;
+    std::vector<std::unique_ptr<StageBase>> stages_;
+    
+    Pipeline(size_t capacity, std::shared_ptr<Channel<Source>> source,
+             std::shared_ptr<Channel<Current>> tail, std::shared_ptr<ErrorSlot> errors,
+             std::vector<std::unique_ptr<StageBase>> stages)
+        : capacity_(capacity), source_(std::move(source)), tail_(std::move(tail)),
+          errors_(std::move(errors)), stages_(std::move(stages)) {}
+    
+public:
+    // channel_capacity bounds every inter-stage queue
+    explicit Pipeline(size_t channel_capacity = 16)
+        : capacity_(std::max<size_t>(1, channel_capacity)),
+          source_(std::make_shared<Channel<Source>>(capacity_)),
+          errors_(std::make_shared<ErrorSlot>()) {
+        static_assert(std::is_same_v<Source, Current>,
+                      "Start a pipeline with Pipeline<T>(capacity)");
+        tail_ = source_;
+    }
+    
+    template<typename Fn>
+    auto then(std::string name, size_t parallelism, Fn fn) && {
+        using Next = std::decay_t<std::invoke_result_t<Fn&, Current&&>>;
+        static_assert(!std::is_void_v<Next>, "Use sink() for a stage that returns nothing");
+        
+        auto next = std::make_shared<Channel<Next>>(capacity_);
+        stages_.push_back(std::make_unique<Stage<Current, Next, Fn>>(
+            std::move(name), parallelism, std::move(fn), tail_, next, errors_));
+        return Pipeline<Source, Next>(capacity_, std::move(source_), std::move(next),
+                                      std::move(errors_), std::move(stages_));
+    }
+    
+    template<typename Fn>
+    RunningPipeline<Source> sink(std::string name, size_t parallelism, Fn fn) && {
+        stages_.push_back(std::make_unique<Stage<Current, void, Fn>>(
+            std::move(name), parallelism, std::move(fn), tail_, nullptr, errors_));
+        return RunningPipeline<Source>(std::move(source_), std::move(errors_),
+                                       std::move(stages_));
+    }
+};
+
+// A pipeline whose workers are running. push() feeds the first stage and
+// blocks while its channel is full; finish() closes the source, waits for
+// every item to leave the sink and rethrows the first stage exception.
+template<typename Source>
+class RunningPipeline {
+private:
+    template<typename, typename> friend class Pipeline;
+    
+    std::shared_ptr<Channel<Source>> source_;
+    std::shared_ptr<ErrorSlot> errors_;
+    std::vector<std::unique_ptr<StageBase>> stages_;
+    bool finished_ = false;
+    
+    RunningPipeline(std::shared_ptr<Channel<Source>> source,
+                    std::shared_ptr<ErrorSlot> errors,
+                    std::vector<std::unique_ptr<StageBase>> stages)
+        : source_(std::move(source)), errors_(std::move(errors)),
+          stages_(std::move(stages)) {
+        for (auto& stage : stages_) {
+            stage->start();
+        }
+    }
+    
+    void close_and_join() {
+        if (finished_) {
+            return;
+        }
+        finished_ = true;
+        source_->close();
+        for (auto& stage : stages_) {
+            stage->join();
+        }
+    }
+    
+public:
+    RunningPipeline(RunningPipeline&&) = default;
+    RunningPipeline(const RunningPipeline&) = delete;
+    RunningPipeline& operator=(const RunningPipeline&) = delete;
+    
+    ~RunningPipeline() {
+        if (source_) {
+            close_and_join();
+        }
+    }
+    
+    void push(Source item) {
+        source_->push(std::move(item));
+    }
+    
+    void finish() {
+        close_and_join();
+        if (errors_->error) {
+            std::rethrow_exception(std::exchange(errors_->error, nullptr));
+        }
+    }
+    
+    std::vector<StageStats> stats() const {
+        std::vector<StageStats> result;
+        for (const auto& stage : stages_) {
+            result.push_back(stage->stats());
+        }
+        return result;
+    }
+};
+
+} // namespace pipeline
+
+// Move-only: the pixel buffer travels through the pipeline and is never copied
+struct Image {
+    int id;
+    std::string name;
+    int processing_stage;  // 0=load, 1=filter, 2=resize, 3=save
+    std::vector<uint8_t> pixels;
+    
+    Image(int id, std::string name)
+        : id(id), name(std::move(name)), processing_stage(0) {}
+    
+    Image(Image&&) noexcept = default;
+    Image& operator=(Image&&) noexcept = default;
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+};
+
+// Simulated per-image stage costs for the throughput comparison
+struct StageCosts {
+    std::chrono::microseconds load{1000};
+    std::chrono::microseconds filter{4000};
+    std::chrono::microseconds resize{2000};
+    std::chrono::microseconds save{1000};
+};
+
+struct BatchResult {
+    double total_ms = 0;
+    double first_saved_ms = 0;  // Latency until the first image is on disk
+    size_t peak_in_flight = 0;  // Images loaded but not yet saved
+};
+
+// Counts images between load and save, and records when the first one is saved
+class BatchTracker {
+private:
+    std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+    std::atomic<size_t> in_flight_{0};
+    std::atomic<size_t> peak_{0};
+    std::atomic<size_t> saved_{0};
+    std::atomic<int64_t> first_saved_ns_{0};
+    
+public:
+    void loaded() {
+        size_t now = in_flight_.fetch_add(1, std::memory_order_relaxed) + 1;
+        size_t peak = peak_.load(std::memory_order_relaxed);
+        while (now > peak && !peak_.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+    }
+    
+    void saved(const Image& img) {
+        if (img.processing_stage != 3) {
+            throw std::runtime_error("image saved before it was resized");
+        }
+        in_flight_.fetch_sub(1, std::memory_order_relaxed);
+        if (saved_.fetch_add(1, std::memory_order_relaxed) == 0) {
+            first_saved_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_).count());
+        }
+    }
+    
+    BatchResult finish(size_t expected) const {
+        if (saved_.load() != expected) {
+            throw std::runtime_error("images lost in the pipeline");
+        }
+        BatchResult result;
+        result.total_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start_).count();
+        result.first_saved_ms = first_saved_ns_.load() / 1e6;
+        result.peak_in_flight = peak_.load();
+        return result;
+    }
 };
 
-void demonstrate_priority_thread_pool() {
+// The old approach: a thread pool plus a future barrier between stages
+BatchResult process_with_future_barriers(size_t n_images, const StageCosts& costs) {
+    BatchTracker tracker;
+    ThreadPoolWithFutures pool(8);
+    
+    auto stage = [&pool](std::vector<std::future<Image>>& previous,
+                         std::chrono::microseconds cost, int stage_number) {
+        std::vector<std::future<Image>> next;
+        for (auto& future : previous) {
+            Image img = future.get();  // Barrier: waits for the item in submission order
+            next.push_back(pool.submit([img = std::move(img), cost, stage_number]() mutable {
+                std::this_thread::sleep_for(cost);
+                img.processing_stage = stage_number;
+                return std::move(img);
+            }));
+        }
+        return next;
+    };
+    
+    std::vector<std::future<Image>> loaded;
+    for (size_t i = 0; i < n_images; ++i) {
+        loaded.push_back(pool.submit([i, &costs, &tracker]() {
+            std::this_thread::sleep_for(costs.load);
+            Image img(static_cast<int>(i), "img" + std::to_string(i) + ".jpg");
+            img.processing_stage = 1;
+            tracker.loaded();
+            return img;
+        }));
+    }
+    auto filtered = stage(loaded, costs.filter, 2);
+    auto resized = stage(filtered, costs.resize, 3);
+    
+    std::vector<std::future<void>> saved;
+    for (auto& future : resized) {
+        Image img = future.get();
+        saved.push_back(pool.submit([img = std::move(img), &costs, &tracker]() {
+            std::this_thread::sleep_for(costs.save);
+            tracker.saved(img);
+        }));
+    }
+    for (auto& future : saved) {
+        future.get();
+    }
+    
+    return tracker.finish(n_images);
+}
+
+// The same work through the streaming pipeline, with the same 8 threads in
+// total, split in proportion to each stage's cost
+BatchResult process_with_pipeline(size_t n_images, const StageCosts& costs,
+                                  std::vector<pipeline::StageStats>* stats_out) {
+    BatchTracker tracker;
+    
+    auto running = pipeline::Pipeline<int>(8)
+        .then("load", 1, [&costs, &tracker](int id) {
+            std::this_thread::sleep_for(costs.load);
+            Image img(id, "img" + std::to_string(id) + ".jpg");
+            img.processing_stage = 1;
+            tracker.loaded();
+            return img;
+        })
+        .then("filter", 4, [&costs](Image img) {
+            std::this_thread::sleep_for(costs.filter);
+            img.processing_stage = 2;
+            return img;
+        })
+        .then("resize", 2, [&costs](Image img) {
+            std::this_thread::sleep_for(costs.resize);
+            img.processing_stage = 3;
+            return img;
+        })
+        .sink("save", 1, [&costs, &tracker](Image img) {
+            std::this_thread::sleep_for(costs.save);
+            tracker.saved(img);
+        });
+    
+    for (size_t i = 0; i < n_images; ++i) {
+        running.push(static_cast<int>(i));
+    }
+    running.finish();
+    
+    if (stats_out) {
+        *stats_out = running.stats();
+    }
+    return tracker.finish(n_images);
+}
+
+void demonstrate_real_world_example() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 7. Real-World Example: Image Processing Pipeline ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    std::cout << "Pipeline: Load → Filter → Resize → Save\n";
+    std::cout << "Strategy: One worker group per stage, bounded channels between them\n\n";
+    
+    std::mutex print_mutex;
+    auto log = [&print_mutex](const char* stage, const Image& img) {
+        std::lock_guard<std::mutex> lock(print_mutex);
+        std::cout << "  [" << stage << "] " << img.name << "\n";
+    };
+    
+    std::vector<std::string> names = {"photo1.jpg", "photo2.jpg", "photo3.jpg", "photo4.jpg"};
+    std::cout << "Processing " << names.size() << " images...\n\n";
+    
+    auto running = pipeline::Pipeline<Image>(2)
+        .then("load", 2, [&log](Image img) {
+            log("LOAD", img);
+            std::this_thread::sleep_for(100ms);
+            img.pixels.assign(64 * 64, 0x80);
+            img.processing_stage = 1;
+            return img;
+        })
+        .then("filter", 2, [&log](Image img) {
+            log("FILTER", img);
+            std::this_thread::sleep_for(150ms);
+            for (auto& p : img.pixels) {
+                p = static_cast<uint8_t>(255 - p);
+            }
+            img.processing_stage = 2;
+            return img;
+        })
+        .then("resize", 1, [&log](Image img) {
+            log("RESIZE", img);
+            std::this_thread::sleep_for(100ms);
+            img.pixels.resize(img.pixels.size() / 4);
+            img.processing_stage = 3;
+            return img;
+        })
+        .sink("save", 1, [&print_mutex](Image img) {
+            std::this_thread::sleep_for(80ms);
+            std::lock_guard<std::mutex> lock(print_mutex);
+            std::cout << "  [SAVE] " << img.name << " → output/" << img.name
+                      << " (" << img.pixels.size() << " bytes)\n";
+        });
+    
+    for (size_t i = 0; i < names.size(); ++i) {
+        running.push(Image(static_cast<int>(i + 1), names[i]));
+    }
+    running.finish();
+    
+    std::cout << "\nBatch: future barriers vs streaming pipeline (8 threads each)\n";
+    StageCosts costs;
+    const size_t n_images = 400;
+    std::cout << "  " << n_images << " images, per-image cost load/filter/resize/save = "
+              << costs.load.count() / 1000.0 << "/" << costs.filter.count() / 1000.0 << "/"
+              << costs.resize.count() / 1000.0 << "/" << costs.save.count() / 1000.0 << " ms\n";
+    
+    BatchResult barrier = process_with_future_barriers(n_images, costs);
+    std::vector<pipeline::StageStats> stats;
+    BatchResult streaming = process_with_pipeline(n_images, costs, &stats);
+    
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  " << std::left << std::setw(20) << "" << std::right << std::setw(10) << "Total ms"
+              << std::setw(16) << "First save ms" << std::setw(12) << "In flight" << "\n";
+    auto print_row = [](const char* label, const BatchResult& r) {
+        std::cout << "  " << std::left << std::setw(20) << label << std::right
+                  << std::setw(10) << r.total_ms << std::setw(16) << r.first_saved_ms
+                  << std::setw(12) << r.peak_in_flight << "\n";
+    };
+    print_row("Future barriers", barrier);
+    print_row("Streaming pipeline", streaming);
+    std::cout << "\n";
+    
+    std::cout << "  " << std::left << std::setw(8) << "Stage" << std::right
+              << std::setw(8) << "Threads" << std::setw(11) << "Processed"
+              << std::setw(12) << "Busy ms" << std::setw(14) << "Queue peak" << "\n";
+    for (const auto& s : stats) {
+        std::cout << "  " << std::left << std::setw(8) << s.name << std::right
+                  << std::setw(8) << s.parallelism << std::setw(11) << s.processed
+                  << std::setw(12) << s.busy_ms << std::setw(14) << s.input_high_water << "\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+    
+    std::cout << "\n✓ Items stream through all stages at once; no per-stage barrier\n";
+    std::cout << "✓ Bounded channels give backpressure: a slow stage throttles its producers\n";
+    std::cout << "✓ Move-only payloads: each pixel buffer is moved, never copied\n";
+    std::cout << "✓ First results arrive after one trip through the stages, not after a whole batch\n";
+    std::cout << "✓ Give the slowest stage the most threads; it sets the throughput\n";
+}
+
+// ============================================================================
+// SECTION 8: Comparison - When to Use What
+// ============================================================================
+
+void demonstrate_comparison() {
     std::cout << "\n" << std::string(70, '=') << "\n";
-    std::cout << "=== 3. Priority Thread Pool ===\n";
+    std::cout << "=== 8. Thread Pool Comparison - When to Use What ===\n";
     std::cout << std::string(70, '=') << "\n\n";
     
-    std::cout << "Concept: Higher priority tasks execute before lower priority ones\n\n";
-    
-    PriorityThreadPool pool(2);
-    
-    std::cout << "Submitting tasks with different priorities...\n\n";
-    
-    // Submit in mixed order
-    pool.submit([]() {
-        std::cout << "  [NORMAL] Task 1\n";
-        std::this_thread::sleep_for(100ms);
-    }, TaskPriority::NORMAL);
+    std::cout << "┌─────────────────────┬─────────────────────┬──────────────────────┐\n";
+    std::cout << "│ Pool Type           │ Use Case            │ Pros/Cons            │\n";
+    std::cout << "├─────────────────────┼─────────────────────┼──────────────────────┤\n";
+    std::cout << "│ Basic               │ Simple tasks        │ + Easy to implement  │\n";
+    std::cout << "│                     │ Fire-and-forget     │ - No return values   │\n";
+    std::cout << "├─────────────────────┼─────────────────────┼──────────────────────┤\n";
+    std::cout << "│ With Futures        │ Computational work  │ + Return values      │\n";
+    std::cout << "│                     │ Need results        │ + Type-safe          │\n";
+    std::cout << "├─────────────────────┼─────────────────────┼──────────────────────┤\n";
+    std::cout << "│ Priority            │ Mixed importance    │ + Predictable order  │\n";
+    std::cout << "│                     │ Real-time systems   │ - More overhead      │\n";
+    std::cout << "├─────────────────────┼─────────────────────┼──────────────────────┤\n";
+    std::cout << "│ Work-Stealing       │ Uneven task sizes   │ + Better load balance│\n";
+    std::cout << "│                     │ Recursive tasks     │ - More complex       │\n";
+    std::cout << "├─────────────────────┼─────────────────────┼──────────────────────┤\n";
+    std::cout << "│ Dynamic             │ Variable workload   │ + Resource efficient │\n";
+    std::cout << "│                     │ Bursty traffic      │ - Scale-up latency   │\n";
+    std::cout << "└─────────────────────┴─────────────────────┴──────────────────────┘\n\n";
     
-    pool.submit([]() {
-        std::cout << "  [CRITICAL] Urgent task!\n";
-        std::this_thread::sleep_for(100ms);
-    }, TaskPriority::CRITICAL);
+    std::cout << "ALTERNATIVES TO THREAD POOLS:\n";
+    std::cout << "──────────────────────────────\n\n";
     
-    pool.submit([]() {
-        std::cout << "  [LOW] Background task\n";
-        std::this_thread::sleep_for(100ms);
-    }, TaskPriority::LOW);
+    std::cout << "1. std::async:\n";
+    std::cout << "   Use when: One-off async operations, automatic thread management\n";
+    std::cout << "   Avoid when: High frequency task submission (creates many threads)\n\n";
     
-    pool.submit([]() {
-        std::cout << "  [HIGH] Important task\n";
-        std::this_thread::sleep_for(100ms);
-    }, TaskPriority::HIGH);
+    std::cout << "2. std::thread:\n";
+    std::cout << "   Use when: Long-running background tasks, dedicated worker\n";
+    std::cout << "   Avoid when: Many short-lived tasks (thread creation overhead)\n\n";
     
-    pool.submit([]() {
-        std::cout << "  [NORMAL] Task 2\n";
-        std::this_thread::sleep_for(100ms);
-    }, TaskPriority::NORMAL);
+    std::cout << "3. ASIO/Boost.Asio:\n";
+    std::cout << "   Use when: I/O-bound operations, async networking\n";
+    std::cout << "   Avoid when: CPU-bound computations\n\n";
     
-    std::this_thread::sleep_for(1s);
+    std::cout << "4. C++20 Coroutines:\n";
+    std::cout << "   Use when: Async I/O, cooperative multitasking\n";
+    std::cout << "   Avoid when: Heavy CPU computations\n\n";
     
-    std::cout << "\n✓ Tasks executed by priority: CRITICAL → HIGH → NORMAL → LOW\n";
+    std::cout << "5. TBB (Threading Building Blocks):\n";
+    std::cout << "   Use when: Need mature, production-ready parallel algorithms\n";
+    std::cout << "   Benefit: Work-stealing, parallel_for, parallel_reduce, etc.\n\n";
 }
 
 // ============================================================================
-// SECTION 4: Work-Stealing Thread Pool (Advanced)
+// SECTION 9: Benchmark - Lock-free Work Stealing vs Mutex Deques
 // ============================================================================
 
-class WorkStealingThreadPool {
+// The previous WorkStealingThreadPool design, kept as a baseline:
+// one std::mutex per std::deque, thieves lock each victim in turn and
+// idle workers poll with sleep_for(10ms).
+class MutexWorkStealingThreadPool {
 private:
     struct WorkerThread {
         std::deque<std::function<void()>> local_queue;
@@ -386,24 +2751,20 @@ private:
     
     std::vector<std::unique_ptr<WorkerThread>> workers_;
     std::atomic<bool> stop_;
-    std::atomic<size_t> next_worker_;  // Round-robin submission
+    std::atomic<size_t> next_worker_;
     
 public:
-    explicit WorkStealingThreadPool(size_t num_threads) 
+    explicit MutexWorkStealingThreadPool(size_t num_threads) 
         : stop_(false), next_worker_(0) {
-        
-        std::cout << "  Creating work-stealing pool with " << num_threads << " workers\n";
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.push_back(std::make_unique<WorkerThread>());
+        }
         
         for (size_t i = 0; i < num_threads; ++i) {
-            auto worker = std::make_unique<WorkerThread>();
-            
-            worker->thread = std::thread([this, i, &w = *worker]() {
-                std::cout << "    Worker " << i << " started\n";
-                
+            workers_[i]->thread = std::thread([this, i, &w = *workers_[i]]() {
                 while (!stop_) {
                     std::function<void()> task;
                     
-                    // Try to get task from own queue first
                     {
                         std::lock_guard<std::mutex> lock(w.queue_mutex);
                         if (!w.local_queue.empty()) {
@@ -412,7 +2773,6 @@ public:
                         }
                     }
                     
-                    // If no local task, try to steal from other workers
                     if (!task) {
                         task = try_steal_work(i);
                     }
@@ -420,24 +2780,21 @@ public:
                     if (task) {
                         task();
                     } else {
-                        std::this_thread::sleep_for(10ms);  // Prevent busy-waiting
+                        std::this_thread::sleep_for(10ms);
                     }
                 }
             });
-            
-            workers_.push_back(std::move(worker));
         }
     }
     
     void submit(std::function<void()> task) {
-        // Round-robin distribution
         size_t worker_idx = next_worker_++ % workers_.size();
         
         std::lock_guard<std::mutex> lock(workers_[worker_idx]->queue_mutex);
         workers_[worker_idx]->local_queue.push_back(std::move(task));
     }
     
-    ~WorkStealingThreadPool() {
+    ~MutexWorkStealingThreadPool() {
         stop_ = true;
         
         for (auto& worker : workers_) {
@@ -445,19 +2802,15 @@ public:
                 worker->thread.join();
             }
         }
-        
-        std::cout << "  Work-stealing pool destroyed\n";
     }
     
 private:
     std::function<void()> try_steal_work(size_t my_index) {
-        // Try to steal from other workers
         for (size_t i = 0; i < workers_.size(); ++i) {
             if (i == my_index) continue;
             
             std::lock_guard<std::mutex> lock(workers_[i]->queue_mutex);
             if (!workers_[i]->local_queue.empty()) {
-                // Steal from the back (different from local FIFO)
                 auto task = std::move(workers_[i]->local_queue.back());
                 workers_[i]->local_queue.pop_back();
                 return task;
@@ -468,65 +2821,692 @@ private:
     }
 };
 
-void demonstrate_work_stealing_pool() {
+// Quiet adapter so the benchmark templates can construct either pool the same way
+struct WorkStealingBenchPool : WorkStealingThreadPool {
+    explicit WorkStealingBenchPool(size_t num_threads)
+        : WorkStealingThreadPool(num_threads, false) {}
+};
+
+// Roughly 100-200ns of arithmetic - well below the 1ms guideline in Section 6
+inline void fine_grained_work(uint64_t seed) {
+    volatile uint64_t x = seed;
+    for (int i = 0; i < 32; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+}
+
+inline void wait_for_count(const std::atomic<size_t>& counter, size_t target) {
+    while (counter.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+    }
+}
+
+// Flat: every task is submitted from the main thread
+template<typename Pool>
+double bench_flat_tasks(size_t num_threads, size_t num_tasks) {
+    std::atomic<size_t> done{0};
+    Pool pool(num_threads);
+    
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_tasks; ++i) {
+        pool.submit([&done, i]() {
+            fine_grained_work(i);
+            done.fetch_add(1, std::memory_order_release);
+        });
+    }
+    wait_for_count(done, num_tasks);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    
+    return std::chrono::duration<double, std::nano>(elapsed).count() / num_tasks;
+}
+
+// Fan-out: a few root tasks each spawn many children from inside the pool,
+// which is where per-worker deques (and stealing) matter
+template<typename Pool>
+double bench_fan_out_tasks(size_t num_threads, size_t num_tasks) {
+    std::atomic<size_t> done{0};
+    Pool pool(num_threads);
+    
+    const size_t roots = num_threads;
+    const size_t children = num_tasks / roots;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < roots; ++r) {
+        pool.submit([&pool, &done, children, r]() {
+            for (size_t c = 0; c < children; ++c) {
+                pool.submit([&done, r, c]() {
+                    fine_grained_work(r ^ c);
+                    done.fetch_add(1, std::memory_order_release);
+                });
+            }
+        });
+    }
+    wait_for_count(done, roots * children);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (roots * children);
+}
+
+// Wake-up latency: submit one task after the pool has gone quiet and
+// measure submit-to-start time
+template<typename Pool>
+std::pair<double, double> bench_wakeup_latency(size_t num_threads, int samples) {
+    Pool pool(num_threads);
+    double total_us = 0.0;
+    double max_us = 0.0;
+    
+    for (int s = 0; s < samples; ++s) {
+        std::this_thread::sleep_for(20ms);  // Let every worker go idle
+        
+        std::atomic<size_t> done{0};
+        std::atomic<int64_t> started_ns{0};
+        auto submitted = std::chrono::steady_clock::now();
+        
+        pool.submit([&]() {
+            started_ns.store((std::chrono::steady_clock::now() - submitted).count(),
+                             std::memory_order_relaxed);
+            done.fetch_add(1, std::memory_order_release);
+        });
+        wait_for_count(done, 1);
+        
+        double us = static_cast<double>(started_ns.load()) / 1000.0;
+        total_us += us;
+        max_us = std::max(max_us, us);
+    }
+    
+    return {total_us / samples, max_us};
+}
+
+void run_work_stealing_benchmark(size_t num_tasks, int latency_samples) {
+    const size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    
+    std::vector<size_t> thread_counts;
+    for (size_t t = 1; t < hw; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(hw);
+    
+    std::cout << "Fine-grained tasks: " << num_tasks << " x ~100ns, ns per task (lower is better)\n\n";
+    std::cout << "  threads │ flat: mutex │ flat: lock-free │ fan-out: mutex │ fan-out: lock-free\n";
+    std::cout << "  ────────┼─────────────┼─────────────────┼────────────────┼───────────────────\n";
+    
+    for (size_t threads : thread_counts) {
+        std::cout << "  " << std::setw(7) << threads << " │"
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(12) << bench_flat_tasks<MutexWorkStealingThreadPool>(threads, num_tasks) << " │"
+                  << std::setw(16) << bench_flat_tasks<WorkStealingBenchPool>(threads, num_tasks) << " │"
+                  << std::setw(15) << bench_fan_out_tasks<MutexWorkStealingThreadPool>(threads, num_tasks) << " │"
+                  << std::setw(18) << bench_fan_out_tasks<WorkStealingBenchPool>(threads, num_tasks) << "\n";
+    }
+    
+    auto [mutex_avg, mutex_max] = bench_wakeup_latency<MutexWorkStealingThreadPool>(hw, latency_samples);
+    auto [lf_avg, lf_max] = bench_wakeup_latency<WorkStealingBenchPool>(hw, latency_samples);
+    
+    std::cout << "\nWake-up latency after idle (" << latency_samples << " samples, µs):\n";
+    std::cout << "  mutex + sleep_for(10ms): avg " << std::setw(9) << mutex_avg
+              << "  max " << std::setw(9) << mutex_max << "\n";
+    std::cout << "  lock-free + futex park:  avg " << std::setw(9) << lf_avg
+              << "  max " << std::setw(9) << lf_max << "\n";
+    std::cout << std::defaultfloat;
+}
+
+void demonstrate_work_stealing_benchmark() {
     std::cout << "\n" << std::string(70, '=') << "\n";
-    std::cout << "=== 4. Work-Stealing Thread Pool ===\n";
+    std::cout << "=== 9. Benchmark: Lock-free vs Mutex Work Stealing ===\n";
     std::cout << std::string(70, '=') << "\n\n";
     
-    std::cout << "Concept: Idle workers steal tasks from busy workers' queues\n";
-    std::cout << "Benefit: Better load balancing for uneven task durations\n\n";
+    // Small sizes for the walkthrough; ThreadPoolBench runs the full version
+    run_work_stealing_benchmark(20'000, 5);
     
-    WorkStealingThreadPool pool(4);
+    std::cout << "\n✓ No lock on the owner's push/pop path, one CAS per steal\n";
+    std::cout << "✓ Parked workers wake on submit instead of after a 10ms poll\n";
+}
+
+// ============================================================================
+// SECTION 10: Benchmark - Heap Allocations per Submit
+// ============================================================================
+
+void print_task_sizes() {
+    std::cout << "sizeof(InplaceTask) = " << sizeof(InplaceTask)
+              << " bytes (" << InplaceTask::kInlineSize << " inline), "
+              << "sizeof(std::function<void()>) = " << sizeof(std::function<void()>) << " bytes\n";
+}
+
+#ifdef THREAD_POOL_ALLOC_BENCH
+
+// Counting replacement for the global allocator. It sees every allocation
+// in the program, so it is compiled only into the ThreadPoolAllocBench
+// target, whose main runs nothing but this benchmark.
+namespace alloc_counter {
+std::atomic<size_t> allocations{0};
+}
+
+// GCC pairs inlined new-expressions with the std::free below and warns;
+// that pairing is exactly what a malloc-backed replacement intends
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    alloc_counter::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+inline size_t allocation_count() {
+    return alloc_counter::allocations.load(std::memory_order_relaxed);
+}
+
+// Runs num_tasks submissions twice: the first pass grows queues and fills
+// the block pool, the second is measured
+template<typename Pool, typename SubmitBatch>
+double allocations_per_submit(Pool& pool, SubmitBatch submit_batch, size_t num_tasks) {
+    std::atomic<size_t> done{0};
     
-    std::cout << "Submitting 12 tasks with varying durations...\n\n";
+    submit_batch(pool, done, num_tasks);
+    wait_for_count(done, num_tasks);
     
-    for (int i = 1; i <= 12; ++i) {
-        pool.submit([i]() {
-            int duration = (i % 3 + 1) * 100;  // 100ms, 200ms, or 300ms
-            std::cout << "  Task " << i << " (duration: " << duration 
-                      << "ms) on thread " << std::this_thread::get_id() << "\n";
-            std::this_thread::sleep_for(std::chrono::milliseconds(duration));
+    size_t before = allocation_count();
+    submit_batch(pool, done, num_tasks);
+    wait_for_count(done, 2 * num_tasks);
+    
+    return static_cast<double>(allocation_count() - before) / num_tasks;
+}
+
+void run_allocation_benchmark(size_t num_tasks) {
+    // Three captures (24 bytes): too big for std::function's 16-byte
+    // small buffer, well inside InplaceTask's 64
+    auto fire_and_forget = [](auto& pool, std::atomic<size_t>& done, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t a = i;
+            uint64_t b = i * 7;
+            pool.submit([&done, a, b]() {
+                fine_grained_work(a ^ b);
+                done.fetch_add(1, std::memory_order_release);
+            });
+        }
+    };
+    
+    auto with_priority = [](PriorityThreadPool& pool, std::atomic<size_t>& done, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t a = i;
+            uint64_t b = i * 7;
+            pool.submit([&done, a, b]() {
+                fine_grained_work(a ^ b);
+                done.fetch_add(1, std::memory_order_release);
+            }, static_cast<TaskPriority>(i % 4));
+        }
+    };
+    
+    std::vector<std::future<uint64_t>> futures;
+    futures.reserve(num_tasks);  // Keep vector growth out of the count
+    auto with_futures = [&futures](ThreadPoolWithFutures& pool, std::atomic<size_t>& done, size_t n) {
+        futures.clear();
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t a = i;
+            uint64_t b = i * 7;
+            futures.push_back(pool.submit([&done, a, b]() {
+                done.fetch_add(1, std::memory_order_release);
+                return a ^ b;
+            }));
+        }
+        for (auto& f : futures) {
+            f.get();
+        }
+    };
+    
+    print_task_sizes();
+    
+    double baseline, basic, futures_pool, priority, stealing, dynamic;
+    {
+        MutexWorkStealingThreadPool pool(2);
+        baseline = allocations_per_submit(pool, fire_and_forget, num_tasks);
+    }
+    {
+        BasicThreadPool pool(2, 0, OverflowPolicy::BLOCK, {}, false);
+        basic = allocations_per_submit(pool, fire_and_forget, num_tasks);
+    }
+    {
+        ThreadPoolWithFutures pool(2);
+        futures_pool = allocations_per_submit(pool, with_futures, num_tasks);
+    }
+    {
+        PriorityThreadPool pool(2);
+        priority = allocations_per_submit(pool, with_priority, num_tasks);
+    }
+    {
+        WorkStealingThreadPool pool(2, false);
+        stealing = allocations_per_submit(pool, fire_and_forget, num_tasks);
+    }
+    {
+        DynamicThreadPool pool(2, 2, {}, {}, false);
+        dynamic = allocations_per_submit(pool, fire_and_forget, num_tasks);
+    }
+    
+    std::cout << "\nGlobal allocations per submit (" << num_tasks << " tasks, after warm-up):\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  std::function + std::deque (old design):   " << baseline << "\n";
+    std::cout << "  BasicThreadPool:                           " << basic << "\n";
+    std::cout << "  ThreadPoolWithFutures (incl. future):      " << futures_pool << "\n";
+    std::cout << "  PriorityThreadPool:                        " << priority << "\n";
+    std::cout << "  WorkStealingThreadPool:                    " << stealing << "\n";
+    std::cout << "  DynamicThreadPool:                         " << dynamic << "\n";
+    std::cout << std::defaultfloat;
+}
+
+#endif  // THREAD_POOL_ALLOC_BENCH
+
+void demonstrate_allocation_benchmark() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 10. Benchmark: Heap Allocations per Submit ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    print_task_sizes();
+    std::cout << "\nCounting allocations means replacing the global operator new, which\n"
+              << "would count every other demo too. Run the ThreadPoolAllocBench target\n"
+              << "for allocations per submit of each pool.\n";
+    
+    std::cout << "\n✓ Small lambdas live inside InplaceTask - no heap copy\n";
+    std::cout << "✓ Move-only: std::promise lives in the task, no shared_ptr<packaged_task>\n";
+    std::cout << "✓ Ring-buffer queues and pooled blocks: steady state never calls malloc\n";
+}
+
+// ============================================================================
+// SECTION 11: Parallel Algorithms on the Work-Stealing Pool
+// ============================================================================
+
+// parallel_for / parallel_reduce / parallel_sort in the spirit of TBB:
+// the index range is cut into chunks of `grain` elements and the chunk
+// range is split recursively - each split pushes its right half onto the
+// worker's own deque where idle workers steal it. One task per chunk, not
+// per element. The calling thread takes part and, instead of blocking,
+// runs queued tasks until the whole range is done (so these may be called
+// from inside a pool task as well).
+namespace parallel {
+
+namespace detail {
+
+// Completion state shared by all tasks of one parallel call
+struct Join {
+    std::atomic<size_t> pending{1};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    
+    void capture(std::exception_ptr e) {
+        if (!failed.exchange(true)) {
+            error = std::move(e);
+        }
+    }
+};
+
+// About 8 chunks per worker: enough slack for stealing to even out
+// imbalance, few enough that task overhead stays negligible
+inline size_t auto_grain(size_t n, size_t workers, size_t min_grain = 1) {
+    return std::max(min_grain, n / (std::max<size_t>(workers, 1) * 8));
+}
+
+template<typename Leaf>
+void fork_chunks(WorkStealingThreadPool& pool, Join& join, const Leaf& leaf,
+                 size_t lo, size_t hi) {
+    // Split off the right half until a single chunk remains
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        join.pending.fetch_add(1, std::memory_order_relaxed);
+        pool.submit([&pool, &join, &leaf, mid, hi]() {
+            fork_chunks(pool, join, leaf, mid, hi);
+        });
+        hi = mid;
+    }
+    
+    if (!join.failed.load(std::memory_order_relaxed)) {
+        try {
+            leaf(lo);
+        } catch (...) {
+            join.capture(std::current_exception());
+        }
+    }
+    join.pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+template<typename Leaf>
+void run_chunks(WorkStealingThreadPool& pool, size_t num_chunks, const Leaf& leaf) {
+    if (num_chunks == 0) {
+        return;
+    }
+    
+    Join join;
+    fork_chunks(pool, join, leaf, 0, num_chunks);
+    pool.help_until([&join]() {
+        return join.pending.load(std::memory_order_acquire) == 0;
+    });
+    
+    if (join.error) {
+        std::rethrow_exception(join.error);
+    }
+}
+
+template<typename It, typename Compare>
+void sort_task(WorkStealingThreadPool& pool, Join& join,
+               It first, It last, Compare comp, size_t cutoff) {
+    using value_type = typename std::iterator_traits<It>::value_type;
+    
+    try {
+        while (static_cast<size_t>(last - first) > cutoff) {
+            // Median-of-three pivot, then a three-way partition so runs of
+            // equal keys don't degrade to O(n²)
+            It mid = first + (last - first) / 2;
+            const value_type& a = *first;
+            const value_type& b = *mid;
+            const value_type& c = *(last - 1);
+            value_type pivot = comp(a, b) ? (comp(b, c) ? b : (comp(a, c) ? c : a))
+                                          : (comp(a, c) ? a : (comp(b, c) ? c : b));
+            
+            It less_end = std::partition(first, last,
+                [&](const value_type& x) { return comp(x, pivot); });
+            It equal_end = std::partition(less_end, last,
+                [&](const value_type& x) { return !comp(pivot, x); });
+            
+            // Right part becomes a stealable task, keep sorting the left
+            join.pending.fetch_add(1, std::memory_order_relaxed);
+            pool.submit([&pool, &join, equal_end, last, comp, cutoff]() {
+                sort_task(pool, join, equal_end, last, comp, cutoff);
+            });
+            last = less_end;
+        }
+        
+        std::sort(first, last, comp);
+    } catch (...) {
+        join.capture(std::current_exception());
+    }
+    join.pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+} // namespace detail
+
+// body(i) for every i in [first, last). grain == 0 picks one automatically.
+template<typename Index, typename Body>
+void parallel_for(WorkStealingThreadPool& pool, Index first, Index last,
+                  const Body& body, size_t grain = 0) {
+    static_assert(std::is_integral_v<Index>, "parallel_for iterates an index range");
+    if (last <= first) {
+        return;
+    }
+    
+    const size_t n = static_cast<size_t>(last - first);
+    if (grain == 0) {
+        grain = detail::auto_grain(n, pool.size());
+    }
+    const size_t num_chunks = (n + grain - 1) / grain;
+    
+    detail::run_chunks(pool, num_chunks, [&](size_t chunk) {
+        Index begin = first + static_cast<Index>(chunk * grain);
+        Index end = first + static_cast<Index>(std::min(n, (chunk + 1) * grain));
+        for (Index i = begin; i < end; ++i) {
+            body(i);
+        }
+    });
+}
+
+// combine(identity, transform(first)), ..., transform(last - 1)).
+// Partial results are combined in index order, so the result is
+// deterministic for non-associative types like double.
+template<typename Index, typename T, typename Transform, typename Combine>
+T parallel_reduce(WorkStealingThreadPool& pool, Index first, Index last, T identity,
+                  const Transform& transform, const Combine& combine, size_t grain = 0) {
+    static_assert(std::is_integral_v<Index>, "parallel_reduce iterates an index range");
+    if (last <= first) {
+        return identity;
+    }
+    
+    const size_t n = static_cast<size_t>(last - first);
+    if (grain == 0) {
+        grain = detail::auto_grain(n, pool.size());
+    }
+    const size_t num_chunks = (n + grain - 1) / grain;
+    
+    std::vector<T> partials(num_chunks, identity);
+    detail::run_chunks(pool, num_chunks, [&](size_t chunk) {
+        Index begin = first + static_cast<Index>(chunk * grain);
+        Index end = first + static_cast<Index>(std::min(n, (chunk + 1) * grain));
+        T acc = identity;
+        for (Index i = begin; i < end; ++i) {
+            acc = combine(std::move(acc), transform(i));
+        }
+        partials[chunk] = std::move(acc);
+    });
+    
+    T result = std::move(identity);
+    for (T& partial : partials) {
+        result = combine(std::move(result), std::move(partial));
+    }
+    return result;
+}
+
+// Parallel quicksort: partitions above `grain` elements fork, below it
+// std::sort takes over. Not stable.
+template<typename RandomIt, typename Compare = std::less<>>
+void parallel_sort(WorkStealingThreadPool& pool, RandomIt first, RandomIt last,
+                   Compare comp = Compare{}, size_t grain = 0) {
+    const size_t n = static_cast<size_t>(last - first);
+    if (n < 2) {
+        return;
+    }
+    if (grain == 0) {
+        grain = detail::auto_grain(n, pool.size(), 2048);
+    }
+    
+    detail::Join join;
+    detail::sort_task(pool, join, first, last, comp, grain);
+    pool.help_until([&join]() {
+        return join.pending.load(std::memory_order_acquire) == 0;
+    });
+    
+    if (join.error) {
+        std::rethrow_exception(join.error);
+    }
+}
+
+} // namespace parallel
+
+void demonstrate_parallel_algorithms() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 11. Parallel Algorithms on the Work-Stealing Pool ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    std::cout << "Concept: Recursive range splitting instead of one task per item\n\n";
+    
+    WorkStealingThreadPool pool(4, false);
+    
+    const size_t n = 1'000'000;
+    std::vector<double> values(n);
+    
+    parallel::parallel_for(pool, size_t{0}, n, [&values](size_t i) {
+        values[i] = static_cast<double>(i % 1000) * 0.5;
+    });
+    std::cout << "  parallel_for:    filled " << n << " elements (auto grain: "
+              << parallel::detail::auto_grain(n, pool.size()) << ")\n";
+    
+    double sum = parallel::parallel_reduce(pool, size_t{0}, n, 0.0,
+        [&values](size_t i) { return values[i]; },
+        [](double a, double b) { return a + b; });
+    double expected = std::accumulate(values.begin(), values.end(), 0.0);
+    std::cout << "  parallel_reduce: sum = " << std::fixed << std::setprecision(1) << sum
+              << " (sequential: " << expected << ")\n" << std::defaultfloat;
+    
+    std::vector<int> data(n);
+    std::mt19937 rng(42);
+    std::generate(data.begin(), data.end(), [&rng]() { return static_cast<int>(rng() % 100'000); });
+    parallel::parallel_sort(pool, data.begin(), data.end());
+    std::cout << "  parallel_sort:   " << n << " ints, sorted = "
+              << std::boolalpha << std::is_sorted(data.begin(), data.end()) << "\n"
+              << std::noboolalpha;
+    
+    std::cout << "\n✓ One task per chunk (~8 chunks per worker), not per element\n";
+    std::cout << "✓ Calling thread helps instead of blocking - safe to nest\n";
+}
+
+// ============================================================================
+// SECTION 12: Benchmark - Parallel Algorithm Scaling
+// ============================================================================
+
+template<typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// A few dozen ns per element so the loop is compute-bound, not memory-bound
+inline double element_work(size_t i) {
+    double x = static_cast<double>(i % 1024) + 1.0;
+    for (int k = 0; k < 8; ++k) {
+        x = std::sqrt(x * 1.0001 + 0.5);
+    }
+    return x;
+}
+
+void run_parallel_scaling_benchmark(size_t n_elements, size_t n_sort) {
+    const size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> thread_counts = {1, 2, 4, 8, hw};
+    std::sort(thread_counts.begin(), thread_counts.end());
+    thread_counts.erase(std::unique(thread_counts.begin(), thread_counts.end()), thread_counts.end());
+    
+    std::vector<double> out(n_elements);
+    std::vector<int> unsorted(n_sort);
+    std::mt19937 rng(7);
+    std::generate(unsorted.begin(), unsorted.end(), [&rng]() { return static_cast<int>(rng()); });
+    
+    // Sequential baselines
+    double seq_for = time_ms([&]() {
+        for (size_t i = 0; i < n_elements; ++i) out[i] = element_work(i);
+    });
+    double seq_sum = 0.0;
+    double seq_reduce = time_ms([&]() {
+        for (size_t i = 0; i < n_elements; ++i) seq_sum += element_work(i);
+    });
+    std::vector<int> sorted = unsorted;
+    double seq_sort = time_ms([&]() { std::sort(sorted.begin(), sorted.end()); });
+    
+    std::cout << "parallel_for/reduce over " << n_elements << " elements, parallel_sort of "
+              << n_sort << " ints (ms, speedup vs sequential)\n\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  threads │      for       │     reduce     │      sort\n";
+    std::cout << "  ────────┼────────────────┼────────────────┼────────────────\n";
+    std::cout << "      seq │ " << std::setw(7) << seq_for << "        │ "
+              << std::setw(7) << seq_reduce << "        │ " << std::setw(7) << seq_sort << "\n";
+    
+    for (size_t threads : thread_counts) {
+        WorkStealingBenchPool pool(threads);
+        
+        double t_for = time_ms([&]() {
+            parallel::parallel_for(pool, size_t{0}, n_elements,
+                                   [&out](size_t i) { out[i] = element_work(i); });
+        });
+        
+        double sum = 0.0;
+        double t_reduce = time_ms([&]() {
+            sum = parallel::parallel_reduce(pool, size_t{0}, n_elements, 0.0,
+                                            element_work, std::plus<>{});
         });
+        
+        std::vector<int> data = unsorted;
+        double t_sort = time_ms([&]() { parallel::parallel_sort(pool, data.begin(), data.end()); });
+        
+        if (data != sorted || std::abs(sum - seq_sum) > 1e-6 * std::abs(seq_sum)) {
+            std::cout << "  !! result mismatch at " << threads << " threads\n";
+        }
+        
+        std::cout << "  " << std::setw(7) << threads << " │ "
+                  << std::setw(7) << t_for << " ×" << std::setw(5) << seq_for / t_for << " │ "
+                  << std::setw(7) << t_reduce << " ×" << std::setw(5) << seq_reduce / t_reduce << " │ "
+                  << std::setw(7) << t_sort << " ×" << std::setw(5) << seq_sort / t_sort << "\n";
+    }
+    std::cout << std::defaultfloat;
+}
+
+void demonstrate_parallel_scaling_benchmark() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 12. Benchmark: Parallel Algorithm Scaling ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
+    
+    run_parallel_scaling_benchmark(1'000'000, 1'000'000);
+    
+    std::cout << "\n✓ Speedup tracks core count until memory bandwidth or the\n";
+    std::cout << "  sequential top-level partition (sort) becomes the limit\n";
+}
+
+// ============================================================================
+// SECTION 13: Benchmark - Priority Scheduling under Contention
+// ============================================================================
+
+// The previous PriorityThreadPool design, kept as a baseline: one binary
+// heap behind one mutex, so every submit and every pop takes the same lock,
+// and the order is strictly by priority (LOW can starve).
+struct PrioritizedTask {
+    InplaceTask func;
+    TaskPriority priority;
+    int sequence;  // For FIFO within same priority
+    
+    bool operator<(const PrioritizedTask& other) const {
+        if (priority != other.priority) {
+            return priority < other.priority;  // Higher priority first
+        }
+        return sequence > other.sequence;  // FIFO for same priority
     }
-    
-    std::this_thread::sleep_for(2s);
-    
-    std::cout << "\n✓ Work stealing enabled better load distribution\n";
-    std::cout << "✓ Idle workers helped busy workers finish faster\n";
-}
-
-// ============================================================================
-// SECTION 5: Dynamic Thread Pool (Auto-scaling)
-// ============================================================================
+};
 
-class DynamicThreadPool {
+class HeapPriorityThreadPool {
 private:
     std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
+    // Binary heap managed with std::push_heap/pop_heap: std::priority_queue
+    // only exposes a const top(), which can't be moved from
+    std::vector<PrioritizedTask> tasks_;
     std::mutex queue_mutex_;
     std::condition_variable condition_;
     bool stop_;
-    
-    size_t min_threads_;
-    size_t max_threads_;
-    std::atomic<size_t> active_threads_;
-    std::atomic<size_t> idle_threads_;
+    std::atomic<int> sequence_counter_;
     
 public:
-    DynamicThreadPool(size_t min_threads, size_t max_threads) 
-        : stop_(false), min_threads_(min_threads), max_threads_(max_threads),
-          active_threads_(0), idle_threads_(0) {
-        
-        std::cout << "  Creating dynamic pool (min: " << min_threads 
-                  << ", max: " << max_threads << ")\n";
+    explicit HeapPriorityThreadPool(size_t num_threads) 
+        : stop_(false), sequence_counter_(0) {
         
-        // Start with minimum threads
-        for (size_t i = 0; i < min_threads_; ++i) {
-            add_worker();
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back([this]() {
+                while (true) {
+                    PrioritizedTask task{{}, TaskPriority::NORMAL, 0};
+                    
+                    {
+                        std::unique_lock<std::mutex> lock(queue_mutex_);
+                        condition_.wait(lock, [this]() {
+                            return stop_ || !tasks_.empty();
+                        });
+                        
+                        if (stop_ && tasks_.empty()) {
+                            return;
+                        }
+                        
+                        std::pop_heap(tasks_.begin(), tasks_.end());
+                        task = std::move(tasks_.back());
+                        tasks_.pop_back();
+                    }
+                    
+                    task.func();
+                }
+            });
         }
     }
     
-    void submit(std::function<void()> task) {
+    void submit(InplaceTask task, TaskPriority priority = TaskPriority::NORMAL) {
         {
             std::lock_guard<std::mutex> lock(queue_mutex_);
             
@@ -534,20 +3514,14 @@ public:
                 throw std::runtime_error("Cannot submit to stopped pool");
             }
             
-            tasks_.push(std::move(task));
-            
-            // Auto-scale: add worker if all busy and below max
-            if (idle_threads_ == 0 && workers_.size() < max_threads_) {
-                std::cout << "  📈 Scaling up: adding worker (total: " 
-                          << (workers_.size() + 1) << ")\n";
-                add_worker();
-            }
+            tasks_.push_back({std::move(task), priority, sequence_counter_++});
+            std::push_heap(tasks_.begin(), tasks_.end());
         }
         
         condition_.notify_one();
     }
     
-    ~DynamicThreadPool() {
+    ~HeapPriorityThreadPool() {
         {
             std::lock_guard<std::mutex> lock(queue_mutex_);
             stop_ = true;
@@ -560,280 +3534,265 @@ public:
                 worker.join();
             }
         }
-        
-        std::cout << "  Dynamic pool destroyed\n";
     }
-    
-private:
-    void add_worker() {
-        workers_.emplace_back([this]() {
-            while (true) {
-                std::function<void()> task;
-                
-                {
-                    std::unique_lock<std::mutex> lock(queue_mutex_);
-                    
-                    ++idle_threads_;
-                    
-                    condition_.wait(lock, [this]() {
-                        return stop_ || !tasks_.empty();
-                    });
-                    
-                    --idle_threads_;
-                    
-                    if (stop_ && tasks_.empty()) {
-                        return;
-                    }
-                    
-                    if (!tasks_.empty()) {
-                        task = std::move(tasks_.front());
-                        tasks_.pop();
-                    }
-                }
-                
-                if (task) {
-                    ++active_threads_;
-                    task();
-                    --active_threads_;
-                }
+};
+
+struct PriorityBenchResult {
+    double tasks_per_sec;
+    double p50_us[kPriorityLevels];
+    double p99_us[kPriorityLevels];
+};
+
+// Class mix per 10 tasks: 1 LOW, 3 NORMAL, 5 HIGH, 1 CRITICAL. Producers
+// submit faster than the workers drain, so the queues stay non-empty and
+// the scheduler's choices decide every class's wait.
+inline TaskPriority bench_priority_of(size_t i) {
+    switch (i % 10) {
+        case 0: return TaskPriority::LOW;
+        case 1: case 2: case 3: return TaskPriority::NORMAL;
+        case 9: return TaskPriority::CRITICAL;
+        default: return TaskPriority::HIGH;
+    }
+}
+
+// Wait = submit → start of execution, recorded per task into a slot of a
+// preallocated vector so that measuring does not contend
+template<typename Pool>
+PriorityBenchResult bench_priority_pool(Pool& pool, size_t producers, size_t tasks_per_producer) {
+    const size_t total = producers * tasks_per_producer;
+    std::vector<int64_t> wait_ns(total);
+    std::atomic<size_t> done{0};
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (size_t i = 0; i < tasks_per_producer; ++i) {
+                const size_t id = p * tasks_per_producer + i;
+                auto submitted = std::chrono::steady_clock::now();
+                pool.submit([&wait_ns, &done, id, submitted]() {
+                    wait_ns[id] = (std::chrono::steady_clock::now() - submitted).count();
+                    fine_grained_work(id);
+                    done.fetch_add(1, std::memory_order_release);
+                }, bench_priority_of(i));
             }
         });
     }
-};
+    for (auto& t : threads) {
+        t.join();
+    }
+    wait_for_count(done, total);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    PriorityBenchResult result{};
+    result.tasks_per_sec = total / seconds;
+    for (size_t level = 0; level < kPriorityLevels; ++level) {
+        std::vector<int64_t> waits;
+        for (size_t id = 0; id < total; ++id) {
+            if (static_cast<size_t>(bench_priority_of(id % tasks_per_producer)) == level) {
+                waits.push_back(wait_ns[id]);
+            }
+        }
+        std::sort(waits.begin(), waits.end());
+        result.p50_us[level] = waits[waits.size() / 2] / 1000.0;
+        result.p99_us[level] = waits[waits.size() * 99 / 100] / 1000.0;
+    }
+    return result;
+}
 
-void demonstrate_dynamic_thread_pool() {
-    std::cout << "\n" << std::string(70, '=') << "\n";
-    std::cout << "=== 5. Dynamic Thread Pool (Auto-scaling) ===\n";
-    std::cout << std::string(70, '=') << "\n\n";
-    
-    std::cout << "Concept: Pool grows/shrinks based on workload\n\n";
-    
-    DynamicThreadPool pool(2, 6);
-    
-    std::cout << "Phase 1: Light load (2 tasks)\n\n";
+void run_priority_benchmark(size_t producers, size_t tasks_per_producer) {
+    const size_t workers = std::max(2u, std::thread::hardware_concurrency());
+    
+    std::cout << producers << " producers × " << tasks_per_producer << " tasks, "
+              << workers << " workers, mix LOW/NORMAL/HIGH/CRITICAL = 10/30/50/10%\n";
+    std::cout << "Wait = submit → start, µs (p50 / p99)\n\n";
+    std::cout << "  scheduler         │  tasks/s  │    CRITICAL     │      HIGH       │     NORMAL      │       LOW\n";
+    std::cout << "  ──────────────────┼───────────┼─────────────────┼─────────────────┼─────────────────┼─────────────────\n";
+    
+    auto print_row = [](const char* name, const PriorityBenchResult& r) {
+        std::cout << "  " << std::left << std::setw(18) << name << std::right << "│"
+                  << std::fixed << std::setprecision(0) << std::setw(10) << r.tasks_per_sec << " │";
+        for (int level = static_cast<int>(kPriorityLevels) - 1; level >= 0; --level) {
+            std::cout << std::setw(7) << r.p50_us[level] << " /" << std::setw(7) << r.p99_us[level]
+                      << (level > 0 ? " │" : "");
+        }
+        std::cout << "\n" << std::defaultfloat;
+    };
     
-    for (int i = 1; i <= 2; ++i) {
-        pool.submit([i]() {
-            std::cout << "  Light task " << i << "\n";
-            std::this_thread::sleep_for(200ms);
-        });
+    {
+        HeapPriorityThreadPool pool(workers);
+        print_row("mutex + heap", bench_priority_pool(pool, producers, tasks_per_producer));
     }
-    
-    std::this_thread::sleep_for(500ms);
-    
-    std::cout << "\nPhase 2: Heavy load (10 tasks)\n\n";
-    
-    for (int i = 1; i <= 10; ++i) {
-        pool.submit([i]() {
-            std::cout << "  Heavy task " << i << "\n";
-            std::this_thread::sleep_for(300ms);
-        });
-        std::this_thread::sleep_for(50ms);  // Gradual submission
+    {
+        PriorityThreadPool pool(workers, std::chrono::microseconds{0}, 16384);
+        print_row("lock-free, strict", bench_priority_pool(pool, producers, tasks_per_producer));
+    }
+    {
+        PriorityThreadPool pool(workers, std::chrono::microseconds{500}, 16384);
+        auto result = bench_priority_pool(pool, producers, tasks_per_producer);
+        print_row("lock-free, aging", result);
+        std::cout << "\n  (aging = 500µs per level, " << pool.promotions() << " promotions)\n";
     }
+}
+
+void demonstrate_priority_benchmark() {
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "=== 13. Benchmark: Priority Scheduling under Contention ===\n";
+    std::cout << std::string(70, '=') << "\n\n";
     
-    std::this_thread::sleep_for(2s);
+    run_priority_benchmark(4, 10'000);
     
-    std::cout << "\n✓ Pool automatically scaled up during heavy load\n";
+    std::cout << "\n✓ Per-level queues: producers of different classes do not share a lock\n";
+    std::cout << "✓ Strict priority: LOW waits for the whole backlog above it\n";
+    std::cout << "✓ Aging caps LOW's wait at the higher classes' wait + 3 aging steps\n";
 }
 
 // ============================================================================
-// SECTION 6: Thread Pool Best Practices and Anti-Patterns
+// SECTION 14: Benchmark - Unified Pool Suite
 // ============================================================================
 
-void demonstrate_best_practices() {
+// Every pool in this file through the PoolBench.h workloads, all with the
+// same worker count. ThreadPoolBench adds SimpleThreadPool and the
+// stop_token ThreadPool and writes the results as JSON.
+std::vector<WorkloadResult> bench_example_pools(const PoolBenchConfig& config) {
+    std::vector<WorkloadResult> all;
+    auto append = [&all](std::vector<WorkloadResult> results) {
+        all.insert(all.end(), results.begin(), results.end());
+    };
+    const size_t n = config.threads;
+    
+    append(run_pool_workloads(
+        "BasicThreadPool",
+        [n]() {
+            return std::make_unique<BasicThreadPool>(n, 0, OverflowPolicy::BLOCK,
+                                                     ThreadPlacement{}, false);
+        },
+        [](BasicThreadPool& pool, InplaceTask task) { pool.submit(std::move(task)); },
+        config));
+    append(run_pool_workloads(
+        "ThreadPoolWithFutures",
+        [n]() { return std::make_unique<ThreadPoolWithFutures>(n); },
+        [](ThreadPoolWithFutures& pool, InplaceTask task) { pool.post(std::move(task)); },
+        config));
+    
+    // A full level makes submit() run tasks on the caller, which looks
+    // like low latency, so those counts are reported with each row. Every
+    // cell is a cache line: 4 levels × queue_capacity × 128 bytes per pool.
+    const size_t capacity = config.queue_capacity;
+    append(run_pool_workloads(
+        "PriorityThreadPool",
+        [n, capacity]() {
+            return std::make_unique<PriorityThreadPool>(n, std::chrono::microseconds{0}, capacity);
+        },
+        [](PriorityThreadPool& pool, InplaceTask task) { pool.submit(std::move(task)); },
+        config,
+        [](const PriorityThreadPool& pool) { return pool.caller_runs(); }));
+    append(run_pool_workloads(
+        "WorkStealingThreadPool",
+        [n]() { return std::make_unique<WorkStealingThreadPool>(n, false); },
+        [](WorkStealingThreadPool& pool, InplaceTask task) { pool.submit(std::move(task)); },
+        config));
+    append(run_pool_workloads(
+        "DynamicThreadPool",
+        [n]() {
+            return std::make_unique<DynamicThreadPool>(1, n, ScalingPolicy{}, ThreadPlacement{},
+                                                       false);
+        },
+        [](DynamicThreadPool& pool, InplaceTask task) { pool.submit(std::move(task)); },
+        config));
+    
+    return all;
+}
+
+void demonstrate_pool_bench_suite() {
     std::cout << "\n" << std::string(70, '=') << "\n";
-    std::cout << "=== 6. Thread Pool Best Practices ===\n";
+    std::cout << "=== 14. Benchmark: Unified Pool Suite ===\n";
     std::cout << std::string(70, '=') << "\n\n";
     
-    std::cout << "✓ BEST PRACTICES:\n";
-    std::cout << "─────────────────\n\n";
-    
-    std::cout << "1. Pool Size Selection:\n";
-    std::cout << "   CPU-bound: num_threads ≈ std::thread::hardware_concurrency()\n";
-    std::cout << "   I/O-bound: num_threads > CPU cores (2x-4x)\n";
-    std::cout << "   Mixed:     Profile and tune based on workload\n\n";
-    
-    std::cout << "2. Task Granularity:\n";
-    std::cout << "   ✓ Tasks should run for at least 1ms (avoid overhead)\n";
-    std::cout << "   ✗ Don't submit trivial tasks (e.g., single addition)\n";
-    std::cout << "   ✓ Batch small operations into larger tasks\n\n";
-    
-    std::cout << "3. Exception Handling:\n";
-    std::cout << "   ✓ Tasks should catch their own exceptions\n";
-    std::cout << "   ✓ Use std::future to propagate exceptions\n";
-    std::cout << "   ✗ Uncaught exceptions terminate worker threads\n\n";
-    
-    std::cout << "4. Shutdown:\n";
-    std::cout << "   ✓ Signal stop before destroying pool\n";
-    std::cout << "   ✓ Join all worker threads in destructor\n";
-    std::cout << "   ✓ Consider draining pending tasks gracefully\n\n";
-    
-    std::cout << "5. Task Dependencies:\n";
-    std::cout << "   ✗ DEADLOCK RISK: Task waiting for another task in same pool\n";
-    std::cout << "   ✓ Use separate pools for dependent tasks\n";
-    std::cout << "   ✓ Or ensure pool size > max dependency depth\n\n";
-    
-    std::cout << "❌ ANTI-PATTERNS:\n";
-    std::cout << "─────────────────\n\n";
-    
-    std::cout << "1. Too many pools: Creates thread explosion\n";
-    std::cout << "   ✗ One pool per operation type (100+ pools)\n";
-    std::cout << "   ✓ One global pool or few specialized pools\n\n";
-    
-    std::cout << "2. Blocking in tasks:\n";
-    std::cout << "   ✗ Task calls blocking I/O (starves other tasks)\n";
-    std::cout << "   ✓ Use async I/O or separate I/O thread pool\n\n";
+    PoolBenchConfig config = PoolBenchConfig::quick();
+    std::cout << "Workloads: empty, skewed (10% long tasks), recursive spawn, producer storm\n";
+    std::cout << "Latency = submit → start of execution; CPU % of all hardware threads\n\n";
     
-    std::cout << "3. Long-running tasks:\n";
-    std::cout << "   ✗ Task runs for minutes/hours (blocks worker)\n";
-    std::cout << "   ✓ Break into smaller chunks or use dedicated thread\n\n";
+    auto results = bench_example_pools(config);
+    std::cout << "\n";
+    print_pool_bench_table(results);
     
-    std::cout << "4. Unbounded queue growth:\n";
-    std::cout << "   ✗ Submit faster than processing (memory exhaustion)\n";
-    std::cout << "   ✓ Use bounded queue with backpressure\n\n";
+    std::cout << "\n✓ Same workloads, same worker count: pick a pool on data\n";
+    std::cout << "✓ ThreadPoolBench runs full sizes, adds the other files' pools, writes JSON\n";
 }
 
 // ============================================================================
-// SECTION 7: Real-World Example - Image Processing Pipeline
+// MAIN FUNCTION
 // ============================================================================
 
-struct Image {
-    int id;
-    std::string name;
-    int processing_stage;  // 0=load, 1=filter, 2=resize, 3=save
-};
+#ifdef THREAD_POOL_BENCH
 
-void demonstrate_real_world_example() {
-    std::cout << "\n" << std::string(70, '=') << "\n";
-    std::cout << "=== 7. Real-World Example: Image Processing Pipeline ===\n";
-    std::cout << std::string(70, '=') << "\n\n";
-    
-    std::cout << "Pipeline: Load → Filter → Resize → Save\n";
-    std::cout << "Strategy: Use thread pool to parallelize each stage\n\n";
-    
-    ThreadPoolWithFutures pool(std::thread::hardware_concurrency());
-    
-    std::vector<Image> images = {
-        {1, "photo1.jpg", 0},
-        {2, "photo2.jpg", 0},
-        {3, "photo3.jpg", 0},
-        {4, "photo4.jpg", 0}
-    };
+// ThreadPoolBench target: same pools, benchmark sections only, full sizes
+//   ThreadPoolBench [--json FILE] [--suite-only]
+int main(int argc, char** argv) {
+    std::string json_path = "thread_pool_bench.json";
+    bool suite_only = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (arg == "--suite-only") {
+            suite_only = true;
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--json FILE] [--suite-only]\n";
+            return 1;
+        }
+    }
     
-    std::cout << "Processing " << images.size() << " images...\n\n";
+    std::cout << "Thread pool benchmarks (" << std::thread::hardware_concurrency()
+              << " hardware threads)\n\n";
     
-    // Stage 1: Load images
-    std::vector<std::future<Image>> loaded;
-    for (const auto& img : images) {
-        loaded.push_back(pool.submit([img]() {
-            std::cout << "  [LOAD] " << img.name << "\n";
-            std::this_thread::sleep_for(100ms);
-            Image result = img;
-            result.processing_stage = 1;
-            return result;
-        }));
+    PoolBenchConfig config;
+    auto results = bench_example_pools(config);
+    for (auto* bench : {bench_simple_thread_pool, bench_stop_token_thread_pool}) {
+        auto more = bench(config);
+        results.insert(results.end(), more.begin(), more.end());
     }
     
-    // Stage 2: Apply filters
-    std::vector<std::future<Image>> filtered;
-    for (auto& future : loaded) {
-        Image img = future.get();
-        filtered.push_back(pool.submit([img]() {
-            std::cout << "  [FILTER] " << img.name << "\n";
-            std::this_thread::sleep_for(150ms);
-            Image result = img;
-            result.processing_stage = 2;
-            return result;
-        }));
-    }
+    std::cout << "\nUnified pool suite (" << config.threads << " workers each)\n";
+    print_pool_bench_table(results);
     
-    // Stage 3: Resize
-    std::vector<std::future<Image>> resized;
-    for (auto& future : filtered) {
-        Image img = future.get();
-        resized.push_back(pool.submit([img]() {
-            std::cout << "  [RESIZE] " << img.name << "\n";
-            std::this_thread::sleep_for(100ms);
-            Image result = img;
-            result.processing_stage = 3;
-            return result;
-        }));
+    std::ofstream json(json_path);
+    if (json) {
+        write_pool_bench_json(json, results, config);
+        json.close();
     }
-    
-    // Stage 4: Save
-    std::vector<std::future<void>> saved;
-    for (auto& future : resized) {
-        Image img = future.get();
-        saved.push_back(pool.submit([img]() {
-            std::cout << "  [SAVE] " << img.name << " → output/" << img.name << "\n";
-            std::this_thread::sleep_for(80ms);
-        }));
+    if (!json) {
+        std::cerr << "\nCannot write JSON to " << json_path << "\n";
+        return 1;
     }
+    std::cout << "\nJSON written to " << json_path << "\n";
     
-    // Wait for all to complete
-    for (auto& future : saved) {
-        future.get();
+    if (suite_only) {
+        return 0;
     }
     
-    std::cout << "\n✓ Pipeline completed for all images\n";
-    std::cout << "✓ Each stage parallelized using thread pool\n";
+    std::cout << "\n";
+    run_work_stealing_benchmark(1'000'000, 50);
+    std::cout << "\n";
+    run_parallel_scaling_benchmark(20'000'000, 10'000'000);
+    std::cout << "\n";
+    run_priority_benchmark(4, 100'000);
+    
+    return 0;
 }
 
-// ============================================================================
-// SECTION 8: Comparison - When to Use What
-// ============================================================================
+#elif defined(THREAD_POOL_ALLOC_BENCH)
 
-void demonstrate_comparison() {
-    std::cout << "\n" << std::string(70, '=') << "\n";
-    std::cout << "=== 8. Thread Pool Comparison - When to Use What ===\n";
-    std::cout << std::string(70, '=') << "\n\n";
-    
-    std::cout << "┌─────────────────────┬─────────────────────┬──────────────────────┐\n";
-    std::cout << "│ Pool Type           │ Use Case            │ Pros/Cons            │\n";
-    std::cout << "├─────────────────────┼─────────────────────┼──────────────────────┤\n";
-    std::cout << "│ Basic               │ Simple tasks        │ + Easy to implement  │\n";
-    std::cout << "│                     │ Fire-and-forget     │ - No return values   │\n";
-    std::cout << "├─────────────────────┼─────────────────────┼──────────────────────┤\n";
-    std::cout << "│ With Futures        │ Computational work  │ + Return values      │\n";
-    std::cout << "│                     │ Need results        │ + Type-safe          │\n";
-    std::cout << "├─────────────────────┼─────────────────────┼──────────────────────┤\n";
-    std::cout << "│ Priority            │ Mixed importance    │ + Predictable order  │\n";
-    std::cout << "│                     │ Real-time systems   │ - More overhead      │\n";
-    std::cout << "├─────────────────────┼─────────────────────┼──────────────────────┤\n";
-    std::cout << "│ Work-Stealing       │ Uneven task sizes   │ + Better load balance│\n";
-    std::cout << "│                     │ Recursive tasks     │ - More complex       │\n";
-    std::cout << "├─────────────────────┼─────────────────────┼──────────────────────┤\n";
-    std::cout << "│ Dynamic             │ Variable workload   │ + Resource efficient │\n";
-    std::cout << "│                     │ Bursty traffic      │ - Scale-up latency   │\n";
-    std::cout << "└─────────────────────┴─────────────────────┴──────────────────────┘\n\n";
-    
-    std::cout << "ALTERNATIVES TO THREAD POOLS:\n";
-    std::cout << "──────────────────────────────\n\n";
-    
-    std::cout << "1. std::async:\n";
-    std::cout << "   Use when: One-off async operations, automatic thread management\n";
-    std::cout << "   Avoid when: High frequency task submission (creates many threads)\n\n";
-    
-    std::cout << "2. std::thread:\n";
-    std::cout << "   Use when: Long-running background tasks, dedicated worker\n";
-    std::cout << "   Avoid when: Many short-lived tasks (thread creation overhead)\n\n";
-    
-    std::cout << "3. ASIO/Boost.Asio:\n";
-    std::cout << "   Use when: I/O-bound operations, async networking\n";
-    std::cout << "   Avoid when: CPU-bound computations\n\n";
-    
-    std::cout << "4. C++20 Coroutines:\n";
-    std::cout << "   Use when: Async I/O, cooperative multitasking\n";
-    std::cout << "   Avoid when: Heavy CPU computations\n\n";
-    
-    std::cout << "5. TBB (Threading Building Blocks):\n";
-    std::cout << "   Use when: Need mature, production-ready parallel algorithms\n";
-    std::cout << "   Benefit: Work-stealing, parallel_for, parallel_reduce, etc.\n\n";
+// ThreadPoolAllocBench target: the allocation benchmark alone, under the
+// counting operator new
+int main() {
+    std::cout << "Heap allocations per submit\n\n";
+    run_allocation_benchmark(100'000);
+    return 0;
 }
 
-// ============================================================================
-// MAIN FUNCTION
-// ============================================================================
+#else
 
 int main() {
     std::cout << "\n";
@@ -848,12 +3807,21 @@ int main() {
     
     demonstrate_basic_thread_pool();
     demonstrate_thread_pool_with_futures();
+    demonstrate_nested_fork_join();
     demonstrate_priority_thread_pool();
     demonstrate_work_stealing_pool();
     demonstrate_dynamic_thread_pool();
+    demonstrate_thread_placement();
     demonstrate_best_practices();
+    demonstrate_backpressure();
     demonstrate_real_world_example();
     demonstrate_comparison();
+    demonstrate_work_stealing_benchmark();
+    demonstrate_allocation_benchmark();
+    demonstrate_parallel_algorithms();
+    demonstrate_parallel_scaling_benchmark();
+    demonstrate_priority_benchmark();
+    demonstrate_pool_bench_suite();
     
     std::cout << "\n" << std::string(70, '=') << "\n";
     std::cout << "All thread pool demonstrations completed!\n";
@@ -867,3 +3835,5 @@ int main() {
     
     return 0;
 }
+
+#endif  // THREAD_POOL_BENCH